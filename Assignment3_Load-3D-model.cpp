@@ -1,6 +1,7 @@
 // Grid Walk 3D — Models version (Top-only camera, polished walls/floor + fog)
 // Needs: glad, glfw, glm, assimp, stb_image
-// LearnOpenGL helpers: FileSystem, Shader (shader_m.h), Model
+// LearnOpenGL helpers: FileSystem; models via gw_modelcache.h (assimp only on cache miss), programs cached as binaries
+// Game logic: gw_world.h (no GL)
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -11,69 +12,67 @@
 #include <glm/gtc/constants.hpp>   // glm::pi, glm::two_pi
 
 #include <learnopengl/filesystem.h>
-#include <learnopengl/shader_m.h>
-#include <learnopengl/model.h>
+
+#include "gw_world.h"
+#include "gw_level.h"
+#include "gw_modelcache.h"
+#include "gw_bench.h"
+#include "gw_replay.h"
+#include "gw_simthread.h"
+#include "gw_capture.h"
+#include "gw_alloc.h"
 
 #include <vector>
 #include <string>
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <chrono>
+#include <future>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 
 // ---------------- Window ----------------
 static const unsigned int GW_SCR_WIDTH = 800;
 static const unsigned int GW_SCR_HEIGHT = 600;
 
-// ---------------- Map ----------------
-static std::vector<std::string> GW_MAP = {
-"###############",
-"#K....#.......#",
-"#.###.#.#####.#",
-"#.#...#.....#.#",
-"#.#.#####.#.#.#",
-"#.#.....#...#.#",
-"#.#####.#.#.#.#",
-"#.....#.#.#...#",
-"###.#.#.#.###.#",
-"#P..#.#.......#",
-"#.###.#.#####.#",
-"#.....#.....#.#",
-"#.#####.###.#.#",
-"#.......#..G#.#",
-"###############"
-};
-// เก็บแผนที่ต้นฉบับไว้สำหรับรีเกม
-static std::vector<std::string> GW_MAP_ORIG = GW_MAP;
-
-static int GW_GRID_W = 0, GW_GRID_H = 0;
-
-static void gw_fixMapWidth() {
-    GW_GRID_H = (int)GW_MAP.size();
-    GW_GRID_W = (int)GW_MAP[0].size();
-    for (auto& r : GW_MAP) {
-        if ((int)r.size() < GW_GRID_W) r += std::string(GW_GRID_W - (int)r.size(), '#');
-        if ((int)r.size() > GW_GRID_W) r = r.substr(0, GW_GRID_W);
-    }
-}
-static inline bool gw_wallAt(int x, int y) {
-    if (x < 0 || x >= GW_GRID_W || y < 0 || y >= GW_GRID_H) return true;
-    return GW_MAP[y][x] == '#';
-}
-static inline glm::vec2 gw_centerOf(const glm::ivec2& t) { return glm::vec2(t) + glm::vec2(0.5f); }
+// เวลาเริ่มโปรแกรม (log เวลา startup: program, model, เฟรมแรก)
+using GWClock = std::chrono::steady_clock;
+static GWClock::time_point gw_startTime = GWClock::now();
+static double gw_msSince(GWClock::time_point t) { return std::chrono::duration<double, std::milli>(GWClock::now() - t).count(); }
 
 // ---------------- Minimal color shader (with fog) ----------------
+// Per-frame uniform block, shared by every program (binding point GW_FRAME_BINDING).
+// gw_makeProgram แทรกให้ทุก shader อัตโนมัติ; model shader (.vs) ประกาศเองให้ตรงกัน
+static const GLuint GW_FRAME_BINDING = 0;
+static const char* GW_FRAME_GLSL = R"(
+layout(std140) uniform GWFrame {
+    mat4 view;
+    mat4 projection;
+    vec4 fogColor;     // rgb
+    vec4 fogParams;    // x = density
+};
+)";
+
 static const char* GW_COLOR_VS = R"(#version 330 core
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
 
-uniform mat4 model, view, projection;
+uniform mat4 model;
+uniform mat3 uNormalMat;   // transpose(inverse(model)) คำนวณบน CPU
+uniform vec3 uColor;
 
 out vec3 N;
 out vec3 Vpos;     // view-space position สำหรับคำนวณหมอก
+out vec3 Col;
 
 void main() {
-    mat3 Nmat = mat3(transpose(inverse(model)));
-    N = normalize(Nmat * aNormal);
+    N = normalize(uNormalMat * aNormal);
+    Col = uColor;
 
     vec4 worldPos = model * vec4(aPos, 1.0);
     vec4 viewPos  = view * worldPos;
@@ -82,45 +81,493 @@ void main() {
     gl_Position = projection * viewPos;
 })";
 
+// Instanced variant: model matrix + color come from per-instance attributes
+static const char* GW_COLOR_INST_VS = R"(#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec3 aNormal;
+layout(location=2) in mat4 iModel;    // ใช้ location 2..5
+layout(location=6) in vec4 iColor;
+
+out vec3 N;
+out vec3 Vpos;
+out vec3 Col;
+
+void main() {
+    // instance มีแค่ translate/rotate + scale ตามแกน และ normal ของ mesh ขนานแกน
+    // จึงใช้ mat3(iModel) ตรงๆ ได้ ไม่ต้อง inverse ต่อ vertex
+    N = normalize(mat3(iModel) * aNormal);
+    Col = iColor.rgb;
+
+    vec4 viewPos = view * iModel * vec4(aPos, 1.0);
+    Vpos = viewPos.xyz;
+
+    gl_Position = projection * viewPos;
+})";
+
+// Merged wall mesh: vertices are already in world space, color alternates per tile
+static const char* GW_WALL_VS = R"(#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec3 aNormal;
+
+uniform vec3 uColor;
+
+out vec3 N;
+out vec3 Vpos;
+out vec3 Col;
+out vec2 Cell;
+
+void main() {
+    N = aNormal;
+    Col = uColor;
+    // ถอยเข้าไปในก้อนผนังครึ่งช่อง เพื่อให้หน้าด้านข้างรู้ว่าเป็นของ tile ไหน
+    Cell = aPos.xz - aNormal.xz * 0.5;
+
+    vec4 viewPos = view * vec4(aPos, 1.0);
+    Vpos = viewPos.xyz;
+
+    gl_Position = projection * viewPos;
+})";
+
 static const char* GW_COLOR_FS = R"(#version 330 core
 in vec3 N;
 in vec3 Vpos;
+in vec3 Col;
+#ifdef GW_CHECKER
+in vec2 Cell;
+uniform vec3 uColorAlt;   // สีของ tile ที่ (x + y) เป็นคี่
+#endif
 
 out vec4 FragColor;
 
-uniform vec3 uColor;
-
-// ปรับแต่งบรรยากาศ
-const vec3  fogColor   = vec3(0.04, 0.05, 0.08);  // สีฉากหลัง
-const float fogDensity = 0.045;                   // เข้มหมอก
-
 void main() {
     vec3 L = normalize(vec3(0.8, 1.2, 0.7));
     float d = max(dot(normalize(N), L), 0.0);
-    vec3 base = uColor * (0.25 + 0.75 * d);
+    vec3 albedo = Col;
+#ifdef GW_CHECKER
+    if (mod(floor(Cell.x) + floor(Cell.y), 2.0) > 0.5) albedo = uColorAlt;
+#endif
+    vec3 base = albedo * (0.25 + 0.75 * d);
 
     // Fog แบบ exponential squared
     float dist = length(Vpos);
-    float fog  = clamp(exp(-pow(fogDensity * dist, 2.0)), 0.0, 1.0);
-    vec3 col   = mix(fogColor, base, fog);
+    float fog  = clamp(exp(-pow(fogParams.x * dist, 2.0)), 0.0, 1.0);
+    vec3 col   = mix(fogColor.rgb, base, fog);
 
     FragColor = vec4(col, 1.0);
 })";
 
-static GLuint gw_makeProgram(const char* vs, const char* fs) {
-    auto comp = [&](GLenum t, const char* s) {
+// ---------------- Program build + binary cache ----------------
+// program ที่ link แล้วเก็บลงดิสก์ (glGetProgramBinary); key = hash ของ source ทุกส่วน + vendor/renderer/version ของ driver
+// เปิดครั้งถัดไปโหลดด้วย glProgramBinary; key ไม่ตรงหรือ driver ไม่รับ binary -> compile ใหม่แล้วเขียนทับ
+// ARB_get_program_binary เป็นของ GL 4.1: โหลด function เองผ่าน GLFW (glad ของโปรเจกต์เป็น 3.3 core)
+typedef void (APIENTRYP GWGetProgramBinaryFn)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+typedef void (APIENTRYP GWProgramBinaryFn)(GLuint, GLenum, const void*, GLsizei);
+typedef void (APIENTRYP GWProgramParameteriFn)(GLuint, GLenum, GLint);
+static const GLenum GW_PROGRAM_BINARY_LENGTH = 0x8741;
+static const GLenum GW_NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+static const GLenum GW_PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+
+static const uint32_t GW_PROGRAM_MAGIC = 0x50575747u;     // "GWWP"
+static const uint32_t GW_PROGRAM_VERSION = 1;
+struct GWProgramFileHeader {
+    uint32_t magic = GW_PROGRAM_MAGIC;
+    uint32_t version = GW_PROGRAM_VERSION;
+    uint32_t format = 0;          // binaryFormat จาก glGetProgramBinary
+    uint32_t bytes = 0;
+    uint64_t key = 0;
+};
+static_assert(sizeof(GWProgramFileHeader) == 24, "GWProgramFileHeader is part of the file format");
+
+struct GWProgramCache {
+    bool enabled = false;
+    std::string dir;
+    uint64_t driverHash = 0;
+    GWGetProgramBinaryFn getBinary = nullptr;
+    GWProgramBinaryFn binary = nullptr;
+    GWProgramParameteriFn parameteri = nullptr;
+    int programs = 0, hits = 0;
+    double ms = 0.0;              // เวลารวมของการสร้าง program ทั้งหมด (compile หรือโหลด)
+};
+static GWProgramCache gw_programs;
+
+// หลังสร้าง context; GW_PROGRAM_CACHE=0 -> compile ทุกครั้ง (ไว้เทียบเวลา)
+static void gw_programCacheInit(const std::string& dir) {
+    GWProgramCache& c = gw_programs;
+    const char* env = std::getenv("GW_PROGRAM_CACHE");
+    if (env && std::atoi(env) == 0) return;
+    c.getBinary = (GWGetProgramBinaryFn)glfwGetProcAddress("glGetProgramBinary");
+    c.binary = (GWProgramBinaryFn)glfwGetProcAddress("glProgramBinary");
+    c.parameteri = (GWProgramParameteriFn)glfwGetProcAddress("glProgramParameteri");
+    GLint formats = 0;
+    if (c.getBinary && c.binary && c.parameteri) glGetIntegerv(GW_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    while (glGetError() != GL_NO_ERROR) {}        // enum ไม่รู้จักบน driver เก่า
+    if (formats <= 0) { std::cout << "Program binary cache unavailable (no binary formats)\n"; return; }
+    std::string driver;
+    for (GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char* str = (const char*)glGetString(e);
+        driver += str ? str : "";
+        driver += '\n';
+    }
+    c.driverHash = gw_hashBytes(14695981039346656037ull ^ GW_PROGRAM_VERSION, (const unsigned char*)driver.data(), driver.size());
+    c.dir = dir;
+    c.enabled = true;
+}
+
+static uint64_t gw_programKey(const std::vector<std::string>& vs, const std::vector<std::string>& fs) {
+    uint64_t h = gw_programs.driverHash;
+    for (const auto* parts : { &vs, &fs })
+        for (const std::string& s : *parts) {
+            uint64_t n = s.size();
+            h = gw_hashBytes(h, (const unsigned char*)&n, sizeof(n));
+            h = gw_hashBytes(h, (const unsigned char*)s.data(), s.size());
+        }
+    return h;
+}
+
+static bool gw_programLinked(GLuint p, const char* name) {
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (ok) return true;
+    char log[1024] = "";
+    glGetProgramInfoLog(p, sizeof(log), nullptr, log);
+    std::cerr << "Program " << name << " link failed: " << log << "\n";
+    return false;
+}
+
+// compile + link จาก source หลายส่วน (ต่อกันตามลำดับ); คืน 0 ถ้า compile/link ไม่ผ่าน (log บอกชื่อ program)
+static GLuint gw_buildProgram(const char* name, const std::vector<std::string>& vs, const std::vector<std::string>& fs) {
+    bool ok = true;
+    auto comp = [&](GLenum t, const std::vector<std::string>& src) {
         GLuint id = glCreateShader(t);
-        glShaderSource(id, 1, &s, nullptr); glCompileShader(id);
-        GLint ok; glGetShaderiv(id, GL_COMPILE_STATUS, &ok);
-        if (!ok) { char log[1024]; glGetShaderInfoLog(id, 1024, nullptr, log); std::cerr << log << "\n"; }
+        std::vector<const char*> parts;
+        for (const std::string& s : src) parts.push_back(s.c_str());
+        glShaderSource(id, (GLsizei)parts.size(), parts.data(), nullptr); glCompileShader(id);
+        GLint done; glGetShaderiv(id, GL_COMPILE_STATUS, &done);
+        if (!done) {
+            char log[1024]; glGetShaderInfoLog(id, 1024, nullptr, log);
+            std::cerr << "Program " << name << (t == GL_VERTEX_SHADER ? " vertex" : " fragment") << " shader: " << log << "\n";
+            ok = false;
+        }
         return id;
         };
     GLuint v = comp(GL_VERTEX_SHADER, vs), f = comp(GL_FRAGMENT_SHADER, fs);
-    GLuint p = glCreateProgram(); glAttachShader(p, v); glAttachShader(p, f); glLinkProgram(p);
-    glDeleteShader(v); glDeleteShader(f); return p;
+    GLuint p = glCreateProgram(); glAttachShader(p, v); glAttachShader(p, f);
+    if (gw_programs.enabled) gw_programs.parameteri(p, GW_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(p);
+    glDeleteShader(v); glDeleteShader(f);
+    if (!ok || !gw_programLinked(p, name)) { glDeleteProgram(p); return 0; }
+    return p;
+}
+
+static GLuint gw_loadProgramBinary(const std::string& path, uint64_t key, const char* name) {
+    std::ifstream f(path, std::ios::binary);
+    GWProgramFileHeader hd;
+    if (!f || !f.read((char*)&hd, sizeof(hd))) return 0;
+    if (hd.magic != GW_PROGRAM_MAGIC || hd.version != GW_PROGRAM_VERSION || hd.key != key || hd.bytes == 0) return 0;
+    std::vector<char> bin(hd.bytes);
+    if (!f.read(bin.data(), (std::streamsize)bin.size())) return 0;
+    GLuint p = glCreateProgram();
+    gw_programs.binary(p, (GLenum)hd.format, bin.data(), (GLsizei)bin.size());
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    while (glGetError() != GL_NO_ERROR) {}        // format ที่ driver ไม่รับ = GL_INVALID_ENUM: ถือว่า miss
+    if (!ok) {
+        std::cout << "Program " << name << ": cached binary rejected by driver, recompiling\n";
+        glDeleteProgram(p);
+        return 0;
+    }
+    return p;
+}
+
+// เขียนไฟล์ชั่วคราวแล้ว rename เหมือน model cache
+static void gw_saveProgramBinary(GLuint p, const std::string& path, uint64_t key) {
+    GLint len = 0;
+    glGetProgramiv(p, GW_PROGRAM_BINARY_LENGTH, &len);
+    if (len <= 0) return;
+    std::vector<char> bin((size_t)len);
+    GWProgramFileHeader hd;
+    GLenum format = 0;
+    GLsizei got = 0;
+    gw_programs.getBinary(p, len, &got, &format, bin.data());
+    if (got <= 0) return;
+    hd.format = format; hd.bytes = (uint32_t)got; hd.key = key;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f || !f.write((const char*)&hd, sizeof(hd)) || !f.write(bin.data(), got)) return;
+    }
+    std::filesystem::rename(tmp, path, ec);
+}
+
+// cache ต่อชื่อ program (<dir>/<name>.gwp): source เปลี่ยน = key ไม่ตรง -> build แล้วเขียนทับไฟล์เดิม
+static GLuint gw_cachedProgram(const char* name, const std::vector<std::string>& vs, const std::vector<std::string>& fs) {
+    GWProgramCache& c = gw_programs;
+    auto t0 = GWClock::now();
+    GLuint p = 0;
+    if (c.enabled) {
+        const uint64_t key = gw_programKey(vs, fs);
+        const std::string path = c.dir + "/" + name + ".gwp";
+        p = gw_loadProgramBinary(path, key, name);
+        if (p) ++c.hits;
+        else if ((p = gw_buildProgram(name, vs, fs))) gw_saveProgramBinary(p, path, key);
+    }
+    else p = gw_buildProgram(name, vs, fs);
+    ++c.programs;
+    c.ms += gw_msSince(t0);
+    return p;
+}
+
+// defines (เช่น "#define GW_CHECKER\n") ถูกแทรกต่อจากบรรทัด #version พร้อม GW_FRAME_GLSL
+static GLuint gw_makeProgram(const char* name, const char* vs, const char* fs, const char* defines = "") {
+    auto split = [defines](const std::string& src) {
+        size_t eol = src.find('\n') + 1;
+        return std::vector<std::string>{ src.substr(0, eol), GW_FRAME_GLSL, defines, src.substr(eol) };
+    };
+    return gw_cachedProgram(name, split(vs), split(fs));
+}
+
+// shader จากไฟล์ (ใช้ตามที่เขียน: ไฟล์ประกาศ GWFrame เอง)
+static GLuint gw_makeProgramFiles(const char* name, const char* vsPath, const char* fsPath) {
+    auto read = [](const char* path, std::string& out) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) { std::cerr << "Cannot read shader " << path << "\n"; return false; }
+        out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        return true;
+    };
+    std::string vs, fs;
+    if (!read(vsPath, vs) || !read(fsPath, fs)) return 0;
+    return gw_cachedProgram(name, { vs }, { fs });
 }
 
-static GLuint gw_colorProg = 0, gw_cubeVAO = 0, gw_cubeVBO = 0;
+// ---------------- Profiler ----------------
+// CPU ต่อเฟส + draw/triangle/uniform ต่อเฟรม (gw_profiler.h); GPU ใช้ GL_TIME_ELAPSED แบบ ring
+// ผลของ query อ่านหลังผ่านไป GW_PROF_LAG เฟรมและเฉพาะเมื่อพร้อมแล้ว -> ไม่ stall pipeline
+static GWProfiler gw_prof;
+
+struct GWGpuTimers {
+    GLuint q[GW_PROF_LAG][GW_GPU_COUNT] = {};
+    bool issued[GW_PROF_LAG][GW_GPU_COUNT] = {};
+    uint64_t frameOf[GW_PROF_LAG] = {};
+    int slot = 0;
+};
+static GWGpuTimers gw_gpu;
+
+static void gw_gpuTimersInit() {
+    glGenQueries(GW_PROF_LAG * GW_GPU_COUNT, &gw_gpu.q[0][0]);
+}
+
+// ต้นเฟรม: เก็บผลของ slot ที่จะใช้ซ้ำ (ออกเมื่อ GW_PROF_LAG เฟรมก่อน); ยังไม่พร้อม = ทิ้ง
+static void gw_gpuFrameBegin(uint64_t frame) {
+    GWGpuTimers& g = gw_gpu;
+    g.slot = (int)(frame % GW_PROF_LAG);
+    for (int p = 0; p < GW_GPU_COUNT; ++p) {
+        if (!g.issued[g.slot][p]) continue;
+        g.issued[g.slot][p] = false;
+        GLint ready = 0;
+        glGetQueryObjectiv(g.q[g.slot][p], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) continue;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(g.q[g.slot][p], GL_QUERY_RESULT, &ns);
+        gw_prof.setGpu(g.frameOf[g.slot], (GWProfGpu)p, ns / 1.0e6);
+    }
+    g.frameOf[g.slot] = frame;
+}
+
+static void gw_gpuBegin(GWProfGpu p) {
+    glBeginQuery(GL_TIME_ELAPSED, gw_gpu.q[gw_gpu.slot][p]);
+    gw_gpu.issued[gw_gpu.slot][p] = true;
+}
+static void gw_gpuEnd() { glEndQuery(GL_TIME_ELAPSED); }
+
+// ---------------- Programs / per-frame uniforms ----------------
+// uniform location ถูก resolve ครั้งเดียวตอนสร้าง program (-1 = ไม่มีใน program นั้น)
+struct GWProgram {
+    GLuint id = 0;
+    GLint model = -1, normalMat = -1, color = -1, colorAlt = -1;
+};
+
+static GLuint gw_curProg = 0;
+static inline void gw_useProgram(GLuint id) {
+    if (id != gw_curProg) { glUseProgram(id); gw_curProg = id; gw_prof.countState(GW_STATE_PROGRAM); }
+}
+
+// ผูก uniform block GWFrame + ดึง location ที่ใช้บ่อย
+static GWProgram gw_resolveProgram(GLuint id) {
+    GWProgram p; p.id = id;
+    GLuint blk = glGetUniformBlockIndex(id, "GWFrame");
+    if (blk != GL_INVALID_INDEX) glUniformBlockBinding(id, blk, GW_FRAME_BINDING);
+    p.model = glGetUniformLocation(id, "model");
+    p.normalMat = glGetUniformLocation(id, "uNormalMat");
+    p.color = glGetUniformLocation(id, "uColor");
+    p.colorAlt = glGetUniformLocation(id, "uColorAlt");
+    return p;
+}
+
+static const float GW_FOG_DENSITY = 0.045f;
+
+// std140 layout ของ GWFrame
+struct GWFrameUniforms {
+    glm::mat4 view{ 1.f };
+    glm::mat4 projection{ 1.f };
+    glm::vec4 fogColor{ 0.04f, 0.05f, 0.08f, 1.f };   // สีฉากหลัง
+    glm::vec4 fogParams{ GW_FOG_DENSITY, 0.f, 0.f, 0.f };   // x = เข้มหมอก
+};
+static GLuint gw_frameUBO = 0;
+
+static void gw_initFrameUBO() {
+    if (gw_frameUBO) return;
+    glGenBuffers(1, &gw_frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, gw_frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(GWFrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, GW_FRAME_BINDING, gw_frameUBO);
+}
+
+// upload view/projection/fog ครั้งเดียวต่อเฟรม
+static void gw_setFrameUniforms(const glm::mat4& V, const glm::mat4& P) {
+    GWFrameUniforms f;
+    f.view = V; f.projection = P;
+    glBindBuffer(GL_UNIFORM_BUFFER, gw_frameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(f), &f);
+    gw_prof.countUniforms();
+}
+
+// ---------------- Render queue ----------------
+// ทุก draw ของฉากส่งเข้าคิว (gw_queueSubmit) แล้ว execute ครั้งเดียวตอนท้ายเฟรม (gw_queueFlush)
+// sort key (บิตสูง -> ต่ำ): pass 2 | program 8 | VAO 16 | texture 16 | depth 22
+//   pass = ช่วงของ GPU timer (GWProfGpu) จึงยังจับเวลา level/models/spheres แยกกันได้
+//   ภายใน pass draw ที่ใช้ program/mesh/texture เดียวกันอยู่ติดกัน, depth ใกล้ -> ไกล (early-z)
+// ตอน execute จำ VAO/texture ที่ผูกอยู่แล้วข้าม bind ซ้ำ (program ใช้ gw_curProg); bind ที่เกิดจริงนับใน profiler
+// id ใน key ตัดเหลือไม่กี่บิต: ชนกันแค่ทำให้เรียงกลุ่มได้ไม่ดีนัก ไม่ผิด (การข้าม bind เทียบค่าจริง)
+// GW_RENDER_SORT=0 -> execute ตามลำดับที่ส่ง (ภายใน pass) ไว้เทียบจำนวน state change
+enum GWDrawKind : uint8_t { GW_DRAW_ARRAYS, GW_DRAW_ELEMENTS, GW_DRAW_LEVEL };
+
+struct GWDrawItem {
+    uint64_t key = 0;
+    const GWProgram* prog = nullptr;
+    GLuint vao = 0;
+    GLuint texture = 0;
+    bool textured = false;                 // false = ไม่แตะ texture unit
+    GWDrawKind kind = GW_DRAW_ELEMENTS;
+    GLsizei count = 0;                     // vertex (ARRAYS) / index (ELEMENTS)
+    GLsizei instances = 0;                 // 0 = ไม่ instanced
+    int32_t matrix = -1;                   // index ใน gw_queue.matrices (-1 = ไม่มี uniform model)
+    glm::vec3 color{ 0.f }, colorAlt{ 0.f };   // ส่งเมื่อ program มี uColor / uColorAlt
+    bool floor = false;                    // GW_DRAW_LEVEL: พื้นหรือผนัง
+};
+
+struct GWRenderQueue {
+    std::vector<GWDrawItem> items;
+    std::vector<glm::mat4> matrices;
+    std::vector<std::pair<uint64_t, uint32_t>> order;   // (key, index) -> sort แล้ว tie ตามลำดับที่ส่ง
+    glm::vec3 eye{ 0.f };
+    float farPlane = 200.f;
+    bool sorted = true;
+};
+static GWRenderQueue gw_queue;
+
+static const int GW_KEY_PASS_SHIFT = 62;
+static const uint64_t GW_KEY_DEPTH_MAX = (1u << 22) - 1;
+
+static void gw_multiDrawChunks(bool floor);
+
+static void gw_queueInit() {
+    const char* env = std::getenv("GW_RENDER_SORT");
+    gw_queue.sorted = !(env && std::atoi(env) == 0);
+}
+
+// ต้นเฟรม: ตำแหน่งกล้องใช้คำนวณ depth ของ key
+static void gw_queueBegin(const glm::vec3& eye, float farPlane) {
+    gw_queue.eye = eye;
+    gw_queue.farPlane = farPlane;
+}
+
+static int32_t gw_queueMatrix(const glm::mat4& M) {
+    gw_queue.matrices.push_back(M);
+    return (int32_t)gw_queue.matrices.size() - 1;
+}
+
+static void gw_queueSubmit(GWDrawItem it, GWProfGpu pass, const glm::vec3& pos) {
+    float d = glm::length(pos - gw_queue.eye) / gw_queue.farPlane;
+    uint64_t depth = (uint64_t)(std::min(std::max(d, 0.f), 1.f) * (float)GW_KEY_DEPTH_MAX);
+    it.key = (uint64_t)pass << GW_KEY_PASS_SHIFT
+        | (uint64_t)(it.prog->id & 0xFF) << 54
+        | (uint64_t)(it.vao & 0xFFFF) << 38
+        | (uint64_t)((it.textured ? it.texture : 0) & 0xFFFF) << 22
+        | depth;
+    gw_queue.items.push_back(it);
+}
+
+static void gw_queueExecute(const GWDrawItem& it, GLuint& vao, GLuint& tex) {
+    const GWProgram& p = *it.prog;
+    gw_useProgram(p.id);
+    if (it.vao != vao) { glBindVertexArray(it.vao); vao = it.vao; gw_prof.countState(GW_STATE_VAO); }
+    if (it.textured && it.texture != tex) { glBindTexture(GL_TEXTURE_2D, it.texture); tex = it.texture; gw_prof.countState(GW_STATE_TEXTURE); }
+
+    uint32_t uniforms = 0;
+    if (it.matrix >= 0 && p.model >= 0) {
+        const glm::mat4& M = gw_queue.matrices[(size_t)it.matrix];
+        glUniformMatrix4fv(p.model, 1, GL_FALSE, glm::value_ptr(M));
+        ++uniforms;
+        if (p.normalMat >= 0) {
+            glm::mat3 Nm = glm::transpose(glm::inverse(glm::mat3(M)));
+            glUniformMatrix3fv(p.normalMat, 1, GL_FALSE, glm::value_ptr(Nm));
+            ++uniforms;
+        }
+    }
+    if (p.color >= 0) { glUniform3f(p.color, it.color.x, it.color.y, it.color.z); ++uniforms; }
+    if (p.colorAlt >= 0) { glUniform3f(p.colorAlt, it.colorAlt.x, it.colorAlt.y, it.colorAlt.z); ++uniforms; }
+    if (uniforms) gw_prof.countUniforms(uniforms);
+
+    const uint64_t inst = it.instances > 0 ? (uint64_t)it.instances : 1;
+    switch (it.kind) {
+    case GW_DRAW_ARRAYS:
+        glDrawArrays(GL_TRIANGLES, 0, it.count);
+        gw_prof.countDraw((uint64_t)(it.count / 3) * inst);
+        break;
+    case GW_DRAW_ELEMENTS:
+        if (it.instances > 0) glDrawElementsInstanced(GL_TRIANGLES, it.count, GL_UNSIGNED_INT, 0, it.instances);
+        else glDrawElements(GL_TRIANGLES, it.count, GL_UNSIGNED_INT, 0);
+        gw_prof.countDraw((uint64_t)(it.count / 3) * inst);
+        break;
+    case GW_DRAW_LEVEL:
+        gw_multiDrawChunks(it.floor);
+        break;
+    }
+}
+
+// sort + execute ทั้งคิว; GPU timer เปิด/ปิดตอนเปลี่ยน pass (pass ที่ไม่มี draw ไม่ออก query)
+static void gw_queueFlush() {
+    GWRenderQueue& q = gw_queue;
+    const uint64_t passMask = ~0ull << GW_KEY_PASS_SHIFT;
+    q.order.clear();
+    for (uint32_t i = 0; i < (uint32_t)q.items.size(); ++i)
+        q.order.push_back({ q.sorted ? q.items[i].key : q.items[i].key & passMask, i });
+    std::sort(q.order.begin(), q.order.end());
+
+    // VAO/texture ที่ผูกไว้นอกคิว (upload ฯลฯ) ไม่รู้ค่า -> bind ครั้งแรกเสมอ
+    GLuint vao = ~0u, tex = ~0u;
+    int pass = -1;
+    glActiveTexture(GL_TEXTURE0);
+    for (const auto& o : q.order) {
+        const GWDrawItem& it = q.items[o.second];
+        const int p = (int)(it.key >> GW_KEY_PASS_SHIFT);
+        if (p != pass) {
+            if (pass >= 0) gw_gpuEnd();
+            gw_gpuBegin((GWProfGpu)p);
+            pass = p;
+        }
+        gw_queueExecute(it, vao, tex);
+    }
+    if (pass >= 0) gw_gpuEnd();
+    if (vao != ~0u) glBindVertexArray(0);
+    q.items.clear();
+    q.matrices.clear();
+}
+
+static GWProgram gw_colorProg;
+static GLuint gw_cubeVAO = 0, gw_cubeVBO = 0;
 static void gw_initCube() {
     if (gw_cubeVAO) return;
     const float v[] = {
@@ -146,18 +593,17 @@ static void gw_initCube() {
     glBindVertexArray(0);
 }
 
-static void gw_drawCube(const glm::mat4& V, const glm::mat4& P, const glm::vec3& pos,
-    const glm::vec3& size, const glm::vec3& color, float yawDeg = 0.f) {
-    glUseProgram(gw_colorProg);
+// gw_colorProg: model + normal matrix + color ต่อ draw (view/projection มาจาก GWFrame); ส่งเข้า render queue
+static void gw_drawCube(const glm::vec3& pos, const glm::vec3& size, const glm::vec3& color, float yawDeg = 0.f) {
     glm::mat4 M(1.f);
     M = glm::translate(M, pos);
     M = glm::rotate(M, glm::radians(yawDeg), glm::vec3(0, 1, 0));
     M = glm::scale(M, size);
-    glUniformMatrix4fv(glGetUniformLocation(gw_colorProg, "model"), 1, GL_FALSE, glm::value_ptr(M));
-    glUniformMatrix4fv(glGetUniformLocation(gw_colorProg, "view"), 1, GL_FALSE, glm::value_ptr(V));
-    glUniformMatrix4fv(glGetUniformLocation(gw_colorProg, "projection"), 1, GL_FALSE, glm::value_ptr(P));
-    glUniform3f(glGetUniformLocation(gw_colorProg, "uColor"), color.x, color.y, color.z);
-    glBindVertexArray(gw_cubeVAO); glDrawArrays(GL_TRIANGLES, 0, 36); glBindVertexArray(0);
+    GWDrawItem it;
+    it.prog = &gw_colorProg; it.vao = gw_cubeVAO;
+    it.kind = GW_DRAW_ARRAYS; it.count = 36;
+    it.matrix = gw_queueMatrix(M); it.color = color;
+    gw_queueSubmit(it, GW_GPU_MODELS, pos);
 }
 
 // ==== Sphere mesh (for bullets / effects) ====
@@ -219,48 +665,386 @@ static void gw_initSphere(int stacks = 12, int slices = 18) {
     glBindVertexArray(0);
 }
 
-static void gw_drawSphere(const glm::mat4& V, const glm::mat4& P,
-    const glm::vec3& center, float radius,
-    const glm::vec3& color) {
-    glUseProgram(gw_colorProg);
+static void gw_drawSphere(const glm::vec3& center, float radius, const glm::vec3& color) {
     glm::mat4 M(1.0f);
     M = glm::translate(M, center);
     M = glm::scale(M, glm::vec3(radius)); // unit sphere -> radius
+    GWDrawItem it;
+    it.prog = &gw_colorProg; it.vao = gw_sphereVAO;
+    it.count = gw_sphereIndexCount;
+    it.matrix = gw_queueMatrix(M); it.color = color;
+    gw_queueSubmit(it, GW_GPU_SPHERES, center);
+}
 
-    glUniformMatrix4fv(glGetUniformLocation(gw_colorProg, "model"), 1, GL_FALSE, glm::value_ptr(M));
-    glUniformMatrix4fv(glGetUniformLocation(gw_colorProg, "view"), 1, GL_FALSE, glm::value_ptr(V));
-    glUniformMatrix4fv(glGetUniformLocation(gw_colorProg, "projection"), 1, GL_FALSE, glm::value_ptr(P));
-    glUniform3f(glGetUniformLocation(gw_colorProg, "uColor"), color.x, color.y, color.z);
+// ---------------- Instancing ----------------
+// Per-instance layout for GW_COLOR_INST_VS (location 2..5 = model, 6 = color)
+struct GWInstance {
+    glm::mat4 model{ 1.f };
+    glm::vec4 color{ 1.f };
+};
 
-    glBindVertexArray(gw_sphereVAO);
-    glDrawElements(GL_TRIANGLES, gw_sphereIndexCount, GL_UNSIGNED_INT, 0);
+static GWProgram gw_colorInstProg, gw_modelInstProg;
+
+// VAO ที่ใช้ mesh เดิม (pos+normal) + buffer ของ instance
+static GLuint gw_makeInstancedVAO(GLuint meshVBO, GLuint meshEBO, GLuint instVBO) {
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    if (meshEBO) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshEBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0); glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instVBO);
+    for (int i = 0; i < 4; ++i) {
+        glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(GWInstance), (void*)(i * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(2 + i);
+        glVertexAttribDivisor(2 + i, 1);
+    }
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(GWInstance), (void*)sizeof(glm::mat4));
+    glEnableVertexAttribArray(6);
+    glVertexAttribDivisor(6, 1);
     glBindVertexArray(0);
+    return vao;
+}
+
+// ---------------- Wall mesher ----------------
+// รวมผนังในสี่เหลี่ยม [x0, x1) x [y0, y1) เป็น mesh เดียว: ตัดหน้าที่ติดกันระหว่างผนัง + หน้าล่าง
+// แล้ว merge หน้าที่อยู่ระนาบเดียวกันเป็น quad ใหญ่ (greedy); quad ไม่ข้ามขอบสี่เหลี่ยม (ขอบ chunk)
+static const float GW_WALL_Y0 = 0.5f, GW_WALL_Y1 = 1.5f;   // ช่วงความสูงเดิมของ gw_drawCube(pos.y = 0.5)
+
+struct GWMeshStats {
+    size_t wallCells = 0;
+    size_t trisBefore = 0, trisAfter = 0;
+    size_t vertsBefore = 0, vertsAfter = 0;
+};
+
+// Outside the map counts as open so the outer faces of the border stay visible
+static inline bool gw_meshWallAt(const GWWorld& w, int x, int y) {
+    return w.grid.inside(x, y) && w.grid.wall(x, y);
+}
+
+// quad จากมุม a และขอบ u, v (vertex = pos(3) + normal(3), เหมือน cube)
+static void gw_emitQuad(std::vector<float>& verts, std::vector<unsigned int>& idx,
+    const glm::vec3& a, const glm::vec3& u, const glm::vec3& v, const glm::vec3& n) {
+    unsigned int base = (unsigned int)(verts.size() / 6);
+    const glm::vec3 c[4] = { a, a + u, a + u + v, a + v };
+    for (const auto& p : c) {
+        verts.push_back(p.x); verts.push_back(p.y); verts.push_back(p.z);
+        verts.push_back(n.x); verts.push_back(n.y); verts.push_back(n.z);
+    }
+    idx.push_back(base); idx.push_back(base + 1); idx.push_back(base + 2);
+    idx.push_back(base); idx.push_back(base + 2); idx.push_back(base + 3);
+}
+
+// ต่อท้าย verts/idx (ไม่ clear) เพื่อให้ build ทีละ chunk ลง buffer เดียวกันได้
+static void gw_meshWalls(const GWWorld& wd, int x0, int y0, int x1, int y1,
+    std::vector<float>& verts, std::vector<unsigned int>& idx) {
+    const float h = GW_WALL_Y1 - GW_WALL_Y0;
+    const int rw = x1 - x0;
+
+    // หน้าบน: greedy 2D (ขยายตามแกน x ก่อน แล้วค่อยขยายลงตามแกน z)
+    std::vector<unsigned char> used((size_t)rw * (y1 - y0), 0);
+    auto usedAt = [&](int x, int y) -> unsigned char& { return used[(size_t)(y - y0) * rw + (x - x0)]; };
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            if (!gw_meshWallAt(wd, x, y)) continue;
+            if (usedAt(x, y)) continue;
+
+            int w = 1;
+            while (x + w < x1 && gw_meshWallAt(wd, x + w, y) && !usedAt(x + w, y)) ++w;
+            int d = 1;
+            for (bool grow = true; grow && y + d < y1; ) {
+                for (int i = 0; i < w; ++i)
+                    if (!gw_meshWallAt(wd, x + i, y + d) || usedAt(x + i, y + d)) { grow = false; break; }
+                if (grow) ++d;
+            }
+            for (int j = 0; j < d; ++j)
+                for (int i = 0; i < w; ++i) usedAt(x + i, y + j) = 1;
+
+            gw_emitQuad(verts, idx, { (float)x, GW_WALL_Y1, (float)y }, { 0, 0, (float)d }, { (float)w, 0, 0 }, { 0, 1, 0 });
+        }
+    }
+
+    // หน้าข้าง: ความสูงเท่ากันทุกก้อน จึง merge แค่ตามแนวยาว (1D) ก็พอ
+    // -z / +z : วิ่งตามแถว y, merge ตามแกน x
+    for (int side = -1; side <= 1; side += 2) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ) {
+                if (!gw_meshWallAt(wd, x, y) || gw_meshWallAt(wd, x, y + side)) { ++x; continue; }
+                int xs = x;
+                while (x < x1 && gw_meshWallAt(wd, x, y) && !gw_meshWallAt(wd, x, y + side)) ++x;
+                float z = (side < 0) ? (float)y : (float)(y + 1);
+                float run = (float)(x - xs);
+                if (side < 0) gw_emitQuad(verts, idx, { (float)xs, GW_WALL_Y0, z }, { 0, h, 0 }, { run, 0, 0 }, { 0, 0, -1 });
+                else          gw_emitQuad(verts, idx, { (float)xs, GW_WALL_Y0, z }, { run, 0, 0 }, { 0, h, 0 }, { 0, 0, 1 });
+            }
+        }
+    }
+    // -x / +x : วิ่งตามคอลัมน์ x, merge ตามแกน z
+    for (int side = -1; side <= 1; side += 2) {
+        for (int x = x0; x < x1; ++x) {
+            for (int y = y0; y < y1; ) {
+                if (!gw_meshWallAt(wd, x, y) || gw_meshWallAt(wd, x + side, y)) { ++y; continue; }
+                int ys = y;
+                while (y < y1 && gw_meshWallAt(wd, x, y) && !gw_meshWallAt(wd, x + side, y)) ++y;
+                float px = (side < 0) ? (float)x : (float)(x + 1);
+                float run = (float)(y - ys);
+                if (side < 0) gw_emitQuad(verts, idx, { px, GW_WALL_Y0, (float)ys }, { 0, 0, run }, { 0, h, 0 }, { -1, 0, 0 });
+                else          gw_emitQuad(verts, idx, { px, GW_WALL_Y0, (float)ys }, { 0, h, 0 }, { 0, 0, run }, { 1, 0, 0 });
+            }
+        }
+    }
 }
 
-// ---------------- Entities ----------------
-struct GWMoveCtrl {
-    bool        moving = false;
-    glm::ivec2  dir{ 0,0 };
-    glm::ivec2  queued{ 0,0 };
-    glm::vec2   target{ 0 };
+// ---------------- Visibility ----------------
+// ระนาบ 6 ด้านของ frustum จาก projection * view (Gribb/Hartmann); normal ชี้เข้าด้านใน
+struct GWFrustum {
+    glm::vec4 planes[6];
+
+    void fromMatrix(const glm::mat4& m) {
+        auto row = [&m](int r) { return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]); };
+        const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+        planes[0] = r3 + r0; planes[1] = r3 - r0;   // left / right
+        planes[2] = r3 + r1; planes[3] = r3 - r1;   // bottom / top
+        planes[4] = r3 + r2; planes[5] = r3 - r2;   // near / far
+    }
+
+    // AABB อยู่นอกถ้ามุมที่ไปทาง normal มากที่สุดยังอยู่หลังระนาบใดระนาบหนึ่ง
+    bool aabbVisible(const glm::vec3& mn, const glm::vec3& mx) const {
+        for (const auto& p : planes) {
+            glm::vec3 v(p.x > 0 ? mx.x : mn.x, p.y > 0 ? mx.y : mn.y, p.z > 0 ? mx.z : mn.z);
+            if (p.x * v.x + p.y * v.y + p.z * v.z + p.w < 0.0f) return false;
+        }
+        return true;
+    }
 };
-struct GWEntity {
-    glm::vec2 pos{ 0 };
-    float     yaw = 0.f;
-    GWMoveCtrl ctrl;
+
+// ระยะที่หมอก (exp2) กลืนเหลือ < 1/255 ของสีจริง: ไกลกว่านี้วาดไปก็เป็นสีหมอกล้วน
+static float gw_fogCullDistance() {
+    return std::sqrt(std::log(255.0f)) / GW_FOG_DENSITY;
+}
+
+// ---------------- Static level (floor + walls) ----------------
+// แบ่งแผนที่เป็น chunk 16x16 tile: ผนัง (greedy ภายใน chunk) + พื้น (quad เดียวต่อ chunk, สีหมากรุกใน FS)
+// อยู่ใน vertex/index buffer เดียว; แต่ละ chunk จำช่วง index ของตัวเอง แล้ววาดเฉพาะ chunk ที่มองเห็น
+// ด้วย glMultiDrawElements ครั้งเดียวต่อวัสดุ
+// mesh ครอบแค่หน้าต่างรอบผู้เล่น (GW_LEVEL_WINDOW บล็อก 64 tile ทุกทิศ > ระยะกล้อง + หมอก) แผนที่ใหญ่
+// จึงไม่ต้อง mesh/อ่านทั้งแผนที่; build ใหม่เมื่อ layout เปลี่ยน (GWWorld::mapRev) หรือผู้เล่นข้ามบล็อก
+static const int GW_CHUNK = 16;
+static const int GW_LEVEL_BLOCK = 64;
+static const int GW_LEVEL_WINDOW = 2;
+
+struct GWLevelChunk {
+    GLsizei wallFirst = 0, wallCount = 0;     // ช่วงใน index buffer (จำนวน index)
+    GLsizei floorFirst = 0, floorCount = 0;
+    glm::vec3 bmin{ 0 }, bmax{ 0 };           // AABB ขยายออก 1 tile ให้ครอบ entity ที่คร่อมขอบ chunk
+    uint32_t visibleFrame = 0;                // == GWVisibility::frame -> เห็นในเฟรมนี้
+    uint32_t keyFirst = 0, keyCount = 0;      // ช่วงใน GWLevelMesh::keys (ปืนที่อยู่ใน chunk นี้)
 };
-struct GWBullet {
-    glm::vec2 pos;
-    glm::vec2 dir;
-    float     life = 1.5f;
-    bool      alive = true;
+struct GWLevelMesh {
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    std::vector<float> verts;
+    std::vector<unsigned int> idx;
+    GWMeshStats stats;
+    int ox = 0, oy = 0;                       // chunk แรกของหน้าต่าง (หน่วย chunk)
+    int cw = 0, ch = 0;                       // จำนวน chunk ตามแกน x / z
+    std::vector<GWLevelChunk> chunks;
+    // index ของ grid.keys เรียงตาม chunk ทั้งแผนที่ (build ครั้งเดียวต่อ layout): chunk ในหน้าต่างหาช่วงของตัวเอง
+    // ด้วย binary search แล้ววาดปืนจากเฉพาะ chunk ที่เห็น -> ต่อเฟรมไม่ไล่ตารางปืนทั้งแผนที่
+    std::vector<uint32_t> keys;
+    std::vector<uint64_t> keyChunk;           // คีย์ chunk (cy << 32 | cx) ของ keys[i] เรียงจากน้อยไปมาก
 };
+// ผลการ cull ของเฟรมปัจจุบัน (entity ใช้ถามว่า chunk ของตัวเองถูกวาดไหม)
+struct GWVisibility {
+    GWFrustum frustum;
+    glm::vec3 camPos{ 0 };
+    float     maxDist = 0.f;
+    uint32_t  frame = 0;
+    std::vector<uint32_t> visible;            // index ของ chunk ที่เห็น
+    std::vector<GLsizei> counts;              // scratch ของ glMultiDrawElements
+    std::vector<const void*> offsets;
+};
+static GWProgram gw_wallProg;
+static GWLevelMesh gw_level;
+static GWVisibility gw_vis;
+static uint32_t gw_levelRev = 0;                  // GWWorld::mapRev ที่ build ไว้ล่าสุด
+static glm::ivec2 gw_levelBlock{ -1,-1 };         // บล็อกของผู้เล่นตอน build ล่าสุด
+static bool gw_levelDirty = false;                // ต้อง upload ใหม่
+
+// Build mesh data on the CPU only when the layout revision or the player's block changes;
+// GL upload happens lazily in gw_drawLevel
+// อ่านเฉพาะ grid/mapRev ของ w (ไม่เปลี่ยนระหว่าง sim thread รัน); ตำแหน่งผู้เล่นมาจาก snapshot
+static void gw_levelSync(const GWWorld& w, const glm::vec2& playerPos) {
+    glm::ivec2 pt = gw_tileOf(playerPos);
+    glm::ivec2 block(pt.x >= 0 ? pt.x / GW_LEVEL_BLOCK : -1, pt.y >= 0 ? pt.y / GW_LEVEL_BLOCK : -1);
+    if (w.mapRev == gw_levelRev && block == gw_levelBlock) return;
+    const bool newLayout = w.mapRev != gw_levelRev;
+    gw_levelRev = w.mapRev;
+    gw_levelBlock = block;
+
+    // หน้าต่าง (tile) ชิดขอบบล็อก ซึ่งเป็นทวีคูณของ GW_CHUNK
+    const int wx0 = std::max(0, (block.x - GW_LEVEL_WINDOW) * GW_LEVEL_BLOCK);
+    const int wy0 = std::max(0, (block.y - GW_LEVEL_WINDOW) * GW_LEVEL_BLOCK);
+    const int wx1 = std::max(wx0, std::min(w.grid.w, (block.x + GW_LEVEL_WINDOW + 1) * GW_LEVEL_BLOCK));
+    const int wy1 = std::max(wy0, std::min(w.grid.h, (block.y + GW_LEVEL_WINDOW + 1) * GW_LEVEL_BLOCK));
+
+    GWLevelMesh& L = gw_level;
+    L.verts.clear(); L.idx.clear();
+    L.ox = wx0 / GW_CHUNK; L.oy = wy0 / GW_CHUNK;
+    L.cw = (wx1 - wx0 + GW_CHUNK - 1) / GW_CHUNK;
+    L.ch = (wy1 - wy0 + GW_CHUNK - 1) / GW_CHUNK;
+    L.chunks.assign((size_t)L.cw * L.ch, GWLevelChunk{});
+    gw_vis.frame = 0;
+    auto chunkKey = [](int cx, int cy) { return (uint64_t)(uint32_t)cy << 32 | (uint32_t)cx; };
+    if (newLayout) {
+        L.keys.resize(w.grid.keys.size());
+        for (uint32_t i = 0; i < (uint32_t)L.keys.size(); ++i) L.keys[i] = i;
+        auto keyOf = [&](uint32_t i) { return chunkKey(w.grid.keys[i].x / GW_CHUNK, w.grid.keys[i].y / GW_CHUNK); };
+        std::sort(L.keys.begin(), L.keys.end(), [&](uint32_t a, uint32_t b) {
+            const uint64_t ka = keyOf(a), kb = keyOf(b);
+            return ka != kb ? ka < kb : a < b;
+        });
+        L.keyChunk.resize(L.keys.size());
+        for (size_t j = 0; j < L.keys.size(); ++j) L.keyChunk[j] = keyOf(L.keys[j]);
+    }
+    for (int cy = 0; cy < L.ch; ++cy) {
+        for (int cx = 0; cx < L.cw; ++cx) {
+            GWLevelChunk& c = L.chunks[(size_t)cy * L.cw + cx];
+            const int x0 = wx0 + cx * GW_CHUNK, y0 = wy0 + cy * GW_CHUNK;
+            const int x1 = std::min(x0 + GW_CHUNK, wx1), y1 = std::min(y0 + GW_CHUNK, wy1);
+
+            c.wallFirst = (GLsizei)L.idx.size();
+            gw_meshWalls(w, x0, y0, x1, y1, L.verts, L.idx);
+            c.wallCount = (GLsizei)L.idx.size() - c.wallFirst;
+
+            // พื้น: ผิวบนของ tile เดิม (สูง 0.02 ผิวอยู่ที่ y = 0) รวมเป็น quad เดียว
+            c.floorFirst = (GLsizei)L.idx.size();
+            gw_emitQuad(L.verts, L.idx, { (float)x0, 0.f, (float)y0 }, { 0, 0, (float)(y1 - y0) }, { (float)(x1 - x0), 0, 0 }, { 0, 1, 0 });
+            c.floorCount = (GLsizei)L.idx.size() - c.floorFirst;
+
+            c.bmin = { x0 - 1.0f, -0.05f, y0 - 1.0f };
+            c.bmax = { x1 + 1.0f, GW_WALL_Y1, y1 + 1.0f };
+
+            const uint64_t key = chunkKey(L.ox + cx, L.oy + cy);
+            auto range = std::equal_range(L.keyChunk.begin(), L.keyChunk.end(), key);
+            c.keyFirst = (uint32_t)(range.first - L.keyChunk.begin());
+            c.keyCount = (uint32_t)(range.second - range.first);
+        }
+    }
 
-// Speeds
-static const float GW_STEP_SPEED_PLAYER = 6.0f;
-static const float GW_STEP_SPEED_ENEMY = 5.0f;
-static const float GW_BULLET_SPEED = 12.0f;
-static const float GW_FIRE_COOLDOWN = 0.25f;
+    // สถิติเทียบกับวาดกล่องทีละ tile (เฉพาะในหน้าต่าง: ไม่อ่านผนังทั้งแผนที่)
+    GWMeshStats& ms = L.stats;
+    const size_t tiles = (size_t)(wx1 - wx0) * (wy1 - wy0);
+    ms.wallCells = 0;
+    for (int y = wy0; y < wy1; ++y)
+        for (int x = wx0; x < wx1; ++x) ms.wallCells += w.grid.wall(x, y) ? 1 : 0;
+    ms.trisBefore = ms.wallCells * 12 + tiles * 12;
+    ms.vertsBefore = ms.wallCells * 36 + tiles * 36;
+    ms.trisAfter = L.idx.size() / 3;
+    ms.vertsAfter = L.verts.size() / 6;
+    if (newLayout)
+        std::cout << "Level mesh: " << (wx1 - wx0) << "x" << (wy1 - wy0) << " tiles of " << w.grid.w << "x" << w.grid.h
+            << ", " << ms.wallCells << " wall cells, " << L.chunks.size() << " chunks, "
+            << ms.trisBefore << " -> " << ms.trisAfter << " triangles, "
+            << ms.vertsBefore << " -> " << ms.vertsAfter << " vertices\n";
+
+    gw_levelDirty = true;
+}
+
+static void gw_uploadLevelMesh(GWLevelMesh& m) {
+    if (!m.vao) {
+        glGenVertexArrays(1, &m.vao); glGenBuffers(1, &m.vbo); glGenBuffers(1, &m.ebo);
+        glBindVertexArray(m.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0); glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); glEnableVertexAttribArray(1);
+    }
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    glBufferData(GL_ARRAY_BUFFER, m.verts.size() * sizeof(float), m.verts.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m.idx.size() * sizeof(unsigned int), m.idx.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+}
+
+// Cull chunks for this frame: only chunks inside the fog radius around the camera are even visited,
+// so the cost depends on what can be on screen, not on the map size
+static void gw_cullLevel(const glm::mat4& PV, const glm::vec3& camPos) {
+    GWVisibility& v = gw_vis;
+    const GWLevelMesh& L = gw_level;
+    v.frustum.fromMatrix(PV);
+    v.camPos = camPos;
+    v.maxDist = gw_fogCullDistance();
+    ++v.frame;
+    v.visible.clear();
+    if (L.chunks.empty()) return;
+
+    const float R = v.maxDist;
+    const int cx0 = std::max(0, (int)std::floor((camPos.x - R) / GW_CHUNK) - L.ox);
+    const int cx1 = std::min(L.cw - 1, (int)std::floor((camPos.x + R) / GW_CHUNK) - L.ox);
+    const int cy0 = std::max(0, (int)std::floor((camPos.z - R) / GW_CHUNK) - L.oy);
+    const int cy1 = std::min(L.ch - 1, (int)std::floor((camPos.z + R) / GW_CHUNK) - L.oy);
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            uint32_t ci = (uint32_t)(cy * L.cw + cx);
+            GWLevelChunk& c = gw_level.chunks[ci];
+            // จุดใน AABB ที่ใกล้กล้องที่สุด ไกลเกินหมอก -> ทั้ง chunk เป็นสีหมอก
+            glm::vec3 d(std::max(c.bmin.x - camPos.x, 0.f) + std::min(c.bmax.x - camPos.x, 0.f),
+                        std::max(c.bmin.y - camPos.y, 0.f) + std::min(c.bmax.y - camPos.y, 0.f),
+                        std::max(c.bmin.z - camPos.z, 0.f) + std::min(c.bmax.z - camPos.z, 0.f));
+            if (glm::dot(d, d) > R * R) continue;
+            if (!v.frustum.aabbVisible(c.bmin, c.bmax)) continue;
+            c.visibleFrame = v.frame;
+            v.visible.push_back(ci);
+        }
+    }
+}
+
+// entity ที่ tile อยู่ใน chunk ที่เห็นเฟรมนี้ (AABB ของ chunk ขยายไว้ 1 tile แล้ว จึงไม่หายตอนคร่อมขอบ)
+static bool gw_chunkVisibleAt(const glm::vec2& p) {
+    const GWLevelMesh& L = gw_level;
+    int cx = (int)std::floor(p.x / GW_CHUNK) - L.ox, cy = (int)std::floor(p.y / GW_CHUNK) - L.oy;
+    if (cx < 0 || cy < 0 || cx >= L.cw || cy >= L.ch) return false;
+    return L.chunks[(size_t)cy * L.cw + cx].visibleFrame == gw_vis.frame;
+}
+
+// วาดช่วง index ของ chunk ที่เห็น (ผนังหรือพื้น) ด้วย draw call เดียว
+static void gw_multiDrawChunks(bool floor) {
+    GWVisibility& v = gw_vis;
+    v.counts.clear(); v.offsets.clear();
+    uint64_t tris = 0;
+    for (uint32_t ci : v.visible) {
+        const GWLevelChunk& c = gw_level.chunks[ci];
+        GLsizei first = floor ? c.floorFirst : c.wallFirst, count = floor ? c.floorCount : c.wallCount;
+        if (count == 0) continue;
+        v.counts.push_back(count);
+        tris += (uint64_t)count / 3;
+        v.offsets.push_back((const void*)(first * sizeof(unsigned int)));
+    }
+    if (v.counts.empty()) return;
+    glMultiDrawElements(GL_TRIANGLES, v.counts.data(), GL_UNSIGNED_INT, v.offsets.data(), (GLsizei)v.counts.size());
+    gw_prof.countDraw(tris);
+}
+
+static void gw_drawLevel() {
+    if (gw_levelDirty) {
+        gw_uploadLevelMesh(gw_level);
+        gw_levelDirty = false;
+    }
+    // พื้นและผนังใช้ shader เดียวกัน: สลับ 2 เฉดตาม tile (เลือกสีใน fragment shader)
+    GWDrawItem it;
+    it.prog = &gw_wallProg; it.vao = gw_level.vao;
+    it.kind = GW_DRAW_LEVEL;
+    it.floor = true;
+    it.color = { 0.10f, 0.12f, 0.16f }; it.colorAlt = { 0.08f, 0.09f, 0.13f };
+    gw_queueSubmit(it, GW_GPU_LEVEL, gw_queue.eye);
+
+    // ผนัง: สลับ 2 เฉดเพื่อให้เห็นทางชัดขึ้น
+    it.floor = false;
+    it.color = { 0.10f, 0.30f, 0.76f }; it.colorAlt = { 0.12f, 0.35f, 0.85f };
+    gw_queueSubmit(it, GW_GPU_LEVEL, gw_queue.eye);
+}
 
 // Mouse wheel zoom
 static float* GW_camDistPtr = nullptr;
@@ -280,86 +1064,555 @@ static glm::ivec2 gw_readInput(GLFWwindow* w) {
     return { 0,0 };
 }
 
-// Enemy greedy steering
-static glm::ivec2 gw_chooseDirChase(const glm::ivec2& fromTile, const glm::ivec2& curDir, const glm::ivec2& playerTile) {
-    std::vector<glm::ivec2> dirs = { {1,0},{-1,0},{0,1},{0,-1} };
-    glm::ivec2 best = curDir; int bestScore = 1e9;
-    for (auto d : dirs) {
-        if (d == -curDir) continue;
-        glm::ivec2 nt = fromTile + d;
-        if (gw_wallAt(nt.x, nt.y)) continue;
-        int s = std::abs(playerTile.x - nt.x) + std::abs(playerTile.y - nt.y);
-        if (s < bestScore) { bestScore = s; best = d; }
-    }
-    if (bestScore == 1e9) {
-        glm::ivec2 rev = -curDir;
-        if (!gw_wallAt(fromTile.x + rev.x, fromTile.y + rev.y)) return rev;
-        return { 0,0 };
-    }
-    return best;
-}
-
-// Draw a Model with transforms
-static void gw_drawModel(Shader& sh, Model& mdl, const glm::mat4& V, const glm::mat4& P,
-    const glm::vec3& pos, const glm::vec3& scl = glm::vec3(1.0f),
-    float yawDeg = 0.f, float pitchDeg = 0.f, float rollDeg = 0.f) {
-    sh.use();
+static glm::mat4 gw_modelMatrix(const glm::vec3& pos, const glm::vec3& scl,
+    float yawDeg, float pitchDeg, float rollDeg) {
     glm::mat4 M(1.f);
     M = glm::translate(M, pos);
     if (yawDeg != 0.f)   M = glm::rotate(M, glm::radians(yawDeg), glm::vec3(0, 1, 0));
     if (pitchDeg != 0.f) M = glm::rotate(M, glm::radians(pitchDeg), glm::vec3(1, 0, 0));
     if (rollDeg != 0.f)  M = glm::rotate(M, glm::radians(rollDeg), glm::vec3(0, 0, 1));
-    M = glm::scale(M, scl);
-    sh.setMat4("model", M);
-    sh.setMat4("view", V);
-    sh.setMat4("projection", P);
-    mdl.Draw(sh);
-}
-
-// ---------- Reset whole game state ----------
-static void gw_resetGame(
-    GWEntity& player, glm::vec2& playerSpawn,
-    std::vector<GWEntity>& ghosts,
-    std::vector<GWBullet>& bullets,
-    bool& hasGun, float& fireCooldown
-) {
-    // คืนแผนที่ต้นฉบับ (มี 'K' กลับมา)
-    GW_MAP = GW_MAP_ORIG;
-    gw_fixMapWidth();
-
-    // ล้างสถานะ
-    ghosts.clear();
-    bullets.clear();
-    hasGun = false;
-    fireCooldown = 0.0f;
-    player = GWEntity{}; // reset movement/yaw
-
-    // สแกนหาจุดเกิดใหม่ของผู้เล่นและผี
-    for (int y = 0; y < GW_GRID_H; ++y) for (int x = 0; x < GW_GRID_W; ++x) {
-        if (GW_MAP[y][x] == 'P') {
-            player.pos = { x + 0.5f, y + 0.5f };
-            playerSpawn = player.pos;
-            GW_MAP[y][x] = '.'; // ลบอักษรออกจากแมพที่ใช้เรนเดอร์
+    return glm::scale(M, scl);
+}
+
+// ---------------- Models (from .gwm cache) ----------------
+// แต่ละ mesh ของ model: VAO (pos/normal/uv ที่ location 0..2) + diffuse texture (0 = ไม่มี)
+// โหลดแบบ async: worker เตรียม cache (gw_prepareModel), thread ของ context upload ทีละนิดทุกเฟรม
+// ระหว่างรอ ready = false -> วาด placeholder แทน
+struct GWModelPart {
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    GLsizei indexCount = 0;
+    GLuint diffuse = 0;
+};
+struct GWModel {
+    std::vector<GWModelPart> parts;
+    std::vector<GLuint> textures;
+    bool ready = false;
+    glm::vec3 placeholder{ 0.4f };             // ขนาดกล่องที่วาดแทนระหว่างโหลด
+};
+
+// texture ตั้งค่าเหมือน TextureFromFile ของ LearnOpenGL; pixel ส่งจาก mapping ตรงๆ
+static size_t gw_uploadModelTexture(const GWModelCache& c, uint32_t i, GWModel& m) {
+    const GWModelTextureRecord& t = c.textures[i];
+    GLenum format = t.channels == 1 ? GL_RED : t.channels == 3 ? GL_RGB : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);              // แถวของ RGB/RED ไม่ได้ pad เป็น 4 byte
+    glGenTextures(1, &m.textures[i]);
+    glBindTexture(GL_TEXTURE_2D, m.textures[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, (GLint)format, t.width, t.height, 0, format, GL_UNSIGNED_BYTE, c.pixels(i));
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return (size_t)t.pixelBytes;
+}
+
+// mesh อ้าง texture ด้วย index จึงต้อง upload texture ทั้งหมดก่อน
+static size_t gw_uploadModelMesh(const GWModelCache& c, uint32_t i, GWModel& m) {
+    const GWModelMeshRecord& r = c.meshes[i];
+    GWModelPart& p = m.parts[i];
+    p.indexCount = (GLsizei)r.indexCount;
+    p.diffuse = r.diffuse >= 0 ? m.textures[r.diffuse] : 0;
+    glGenVertexArrays(1, &p.vao); glGenBuffers(1, &p.vbo); glGenBuffers(1, &p.ebo);
+    glBindVertexArray(p.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, p.vbo);
+    glBufferData(GL_ARRAY_BUFFER, r.vertexCount * sizeof(GWModelVertex), c.vertices(i), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, p.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, r.indexCount * sizeof(uint32_t), c.indices(i), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GWModelVertex), (void*)offsetof(GWModelVertex, pos)); glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GWModelVertex), (void*)offsetof(GWModelVertex, normal)); glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GWModelVertex), (void*)offsetof(GWModelVertex, uv)); glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    return (size_t)r.vertexCount * sizeof(GWModelVertex) + (size_t)r.indexCount * sizeof(uint32_t);
+}
+
+// งานโหลดที่ยังไม่เสร็จ: future ของ worker แล้วตามด้วย upload ที่ค้างอยู่
+struct GWModelJob {
+    GWModel* target = nullptr;
+    std::string name;
+    std::future<GWModelPrep> future;
+    GWModelPrep prep;
+    bool prepared = false;
+    uint32_t nextTexture = 0, nextMesh = 0;
+    int uploadFrames = 0;
+    double uploadMs = 0.0;
+};
+static std::vector<GWModelJob> gw_modelJobs;
+static const size_t GW_UPLOAD_BUDGET = 8u << 20;     // byte ต่อเฟรม (อย่างน้อย 1 texture/mesh ต่อเฟรมเสมอ)
+
+// เริ่มโหลดบน worker ทันที; GW_MODEL_CACHE=0 -> build ใหม่ทุกครั้ง (ไว้เทียบเวลากับทาง assimp)
+static void gw_requestModel(GWModel& target, const std::string& objPath, const std::string& cachePath, const glm::vec3& placeholder) {
+    const char* env = std::getenv("GW_MODEL_CACHE");
+    const bool useCache = !(env && std::atoi(env) == 0);
+    target.placeholder = placeholder;
+    GWModelJob job;
+    job.target = &target;
+    job.name = cachePath.substr(cachePath.find_last_of("/\\") + 1);
+    job.future = std::async(std::launch::async, gw_prepareModel, objPath, cachePath, useCache);
+    gw_modelJobs.push_back(std::move(job));
+}
+
+// เรียกทุกเฟรมบน thread ของ context: รับผลจาก worker ที่เสร็จแล้ว + upload ไม่เกิน budget
+static void gw_pumpModelUploads() {
+    size_t spent = 0;
+    for (auto& job : gw_modelJobs) {
+        if (!job.prepared) {
+            if (job.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+            job.prep = job.future.get();
+            job.prepared = true;
+            if (!job.prep.ok) { std::cerr << "Model " << job.name << ": " << job.prep.error << "\n"; continue; }
+            job.target->textures.resize(job.prep.cache.header->textureCount, 0);
+            job.target->parts.resize(job.prep.cache.header->meshCount);
+        }
+        if (!job.prep.ok || spent >= GW_UPLOAD_BUDGET) continue;
+
+        const GWModelCache& c = job.prep.cache;
+        GWModel& m = *job.target;
+        auto t0 = GWClock::now();
+        while (spent < GW_UPLOAD_BUDGET && job.nextTexture < c.header->textureCount)
+            spent += gw_uploadModelTexture(c, job.nextTexture++, m);
+        while (spent < GW_UPLOAD_BUDGET && job.nextTexture == c.header->textureCount && job.nextMesh < c.header->meshCount)
+            spent += gw_uploadModelMesh(c, job.nextMesh++, m);
+        job.uploadMs += gw_msSince(t0);
+        ++job.uploadFrames;
+
+        if (job.nextTexture == c.header->textureCount && job.nextMesh == c.header->meshCount) {
+            m.ready = true;
+            std::cout << "Model " << job.name << ": " << (job.prep.hit ? "cache hit" : "built") << ", ready "
+                << gw_msSince(gw_startTime) << " ms after start (worker: hash " << job.prep.hashMs << " ms, "
+                << (job.prep.hit ? "map " : "assimp+write ") << job.prep.loadMs << " ms; upload " << job.uploadMs
+                << " ms over " << job.uploadFrames << " frames; " << m.parts.size() << " meshes, "
+                << m.textures.size() << " textures)\n";
+        }
+    }
+    gw_modelJobs.erase(std::remove_if(gw_modelJobs.begin(), gw_modelJobs.end(), [](const GWModelJob& j) {
+        return j.prepared && (!j.prep.ok || j.target->ready);
+    }), gw_modelJobs.end());
+}
+
+// Draw a model with transforms (view/projection มาจาก GWFrame); diffuse ที่ texture unit 0
+// ส่งเข้า render queue ทีละ mesh (matrix เดียวกัน) -> ปืนหลายกระบอก bind VAO/texture ต่อ mesh ครั้งเดียว
+// ยังโหลดไม่เสร็จ -> กล่องสีเทาขนาด placeholder วางบนจุดเดียวกัน
+static GWProgram gw_modelProg;
+static void gw_drawModel(const GWModel& mdl,
+    const glm::vec3& pos, const glm::vec3& scl = glm::vec3(1.0f),
+    float yawDeg = 0.f, float pitchDeg = 0.f, float rollDeg = 0.f) {
+    if (!mdl.ready) {
+        gw_drawCube(pos + glm::vec3(0.f, mdl.placeholder.y * 0.5f, 0.f), mdl.placeholder, { 0.45f, 0.45f, 0.5f }, yawDeg);
+        return;
+    }
+    GWDrawItem it;
+    it.prog = &gw_modelProg;
+    it.textured = true;
+    it.matrix = gw_queueMatrix(gw_modelMatrix(pos, scl, yawDeg, pitchDeg, rollDeg));
+    for (const auto& p : mdl.parts) {
+        it.vao = p.vao; it.texture = p.diffuse; it.count = p.indexCount;
+        gw_queueSubmit(it, GW_GPU_MODELS, pos);
+    }
+}
+
+// ---------------- Instanced entities (ghosts, cores, bullets) ----------------
+// Instanced variant of the model shader: model matrix per instance at location 3..6
+static const char* GW_MODEL_INST_VS = R"(#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=2) in vec2 aTexCoords;
+layout(location=3) in mat4 iModel;
+
+out vec2 TexCoords;
+
+void main() {
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * iModel * vec4(aPos, 1.0);
+})";
+
+static const char* GW_MODEL_FS = R"(#version 330 core
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D texture_diffuse1;
+
+void main() {
+    FragColor = texture(texture_diffuse1, TexCoords);
+})";
+
+// buffer ต่อเฟรม: orphan (glBufferData(nullptr)) ก่อนเขียน เพื่อไม่ต้องรอ GPU อ่านเฟรมก่อนหน้า
+struct GWInstanceStream {
+    GLuint vbo = 0;
+    size_t capacity = 0;     // bytes
+    GLsizei count = 0;
+};
+
+static void gw_streamInit(GWInstanceStream& st) {
+    if (!st.vbo) glGenBuffers(1, &st.vbo);
+}
+
+static void gw_streamUpload(GWInstanceStream& st, const std::vector<GWInstance>& inst) {
+    gw_streamInit(st);
+    size_t bytes = inst.size() * sizeof(GWInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, st.vbo);
+    if (bytes > st.capacity) st.capacity = std::max(bytes, st.capacity * 2);
+    glBufferData(GL_ARRAY_BUFFER, st.capacity, nullptr, GL_STREAM_DRAW);
+    if (bytes) glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, inst.data());
+    st.count = (GLsizei)inst.size();
+}
+
+// ผูก instance buffer เข้ากับ VAO ของทุก mesh ใน model (ทำครั้งเดียว)
+static void gw_bindModelInstances(const GWModel& mdl, GLuint instVBO) {
+    for (const auto& p : mdl.parts) {
+        glBindVertexArray(p.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instVBO);
+        for (int i = 0; i < 4; ++i) {
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(GWInstance), (void*)(i * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(3 + i);
+            glVertexAttribDivisor(3 + i, 1);
+        }
+    }
+    glBindVertexArray(0);
+}
+
+// One instanced draw per mesh; only the first diffuse texture is used, same as GW_MODEL_FS
+static void gw_drawModelInstanced(const GWModel& mdl, const GWInstanceStream& st) {
+    if (st.count == 0) return;
+    GWDrawItem it;
+    it.prog = &gw_modelInstProg;
+    it.textured = true;
+    it.instances = st.count;
+    for (const auto& p : mdl.parts) {
+        it.vao = p.vao; it.texture = p.diffuse; it.count = p.indexCount;
+        gw_queueSubmit(it, GW_GPU_MODELS, gw_queue.eye);
+    }
+}
+
+struct GWEntityRenderer {
+    GWInstanceStream ghosts;              // rock model
+    GWInstanceStream spheres;             // แกนพลังของผี + กระสุน (mesh เดียวกัน)
+    GLuint sphereVAO = 0;
+    const GWModel* ghostModel = nullptr;
+    bool ghostBound = false;              // instance buffer ผูกกับ VAO ของ model แล้ว (หลังโหลดเสร็จ)
+    std::vector<GWInstance> ghostInst, sphereInst;   // reuse capacity ทุกเฟรม
+};
+static GWEntityRenderer gw_entities;
+
+static void gw_initEntityRenderer(const GWModel& ghostModel) {
+    GWEntityRenderer& r = gw_entities;
+    gw_streamInit(r.ghosts);
+    gw_streamInit(r.spheres);
+    r.sphereVAO = gw_makeInstancedVAO(gw_sphereVBO, gw_sphereEBO, r.spheres.vbo);
+    r.ghostModel = &ghostModel;
+}
+
+static void gw_drawEntities() {
+    GWEntityRenderer& r = gw_entities;
+    gw_streamUpload(r.ghosts, r.ghostInst);
+    gw_streamUpload(r.spheres, r.sphereInst);
+
+    if (r.ghostModel && r.ghostModel->ready) {
+        if (!r.ghostBound) { gw_bindModelInstances(*r.ghostModel, r.ghosts.vbo); r.ghostBound = true; }
+        gw_drawModelInstanced(*r.ghostModel, r.ghosts);
+    }
+    if (r.spheres.count > 0) {
+        GWDrawItem it;
+        it.prog = &gw_colorInstProg; it.vao = r.sphereVAO;
+        it.count = gw_sphereIndexCount; it.instances = r.spheres.count;
+        gw_queueSubmit(it, GW_GPU_SPHERES, gw_queue.eye);
+    }
+}
+
+// ---------------- Render benchmark ----------------
+// ./Assignment3 --bench [...]: maze ตาม scenario, bot เล่นแทน, 1 tick ต่อเฟรม, วาดลง FBO นอกจอ (หน้าต่างซ่อน)
+// ใช้กับ Mesa llvmpipe ได้ (LIBGL_ALWAYS_SOFTWARE=1, บนเครื่องไม่มีจอใช้ xvfb-run); glFinish ทุกเฟรมให้เวลารวมงาน GPU
+struct GWRenderBench {
+    bool on = false;
+    GWBenchScenario sc;                     // sc.ticks = จำนวนเฟรมที่วัด
+    const char* jsonPath = nullptr;
+    std::vector<glm::ivec2> open;
+    GWBot bot;
+    uint32_t rng = 1;
+    GLuint fbo = 0, colorRb = 0, depthRb = 0;
+    int warmup = 60;                        // เฟรมหลังโมเดลโหลดครบ ก่อนเริ่มเก็บ
+    std::vector<double> frameMs, cpuMs[GW_PROF_CPU_COUNT];
+};
+static GWRenderBench gw_bench;
+
+static bool gw_benchParse(int argc, char** argv) {
+    GWRenderBench& b = gw_bench;
+    b.on = true;
+    b.sc.name = "render";
+    b.sc.size = 256; b.sc.ghosts = 1000; b.sc.bullets = 256; b.sc.fireEvery = 5; b.sc.ticks = 600;
+    for (int i = 2; i < argc; ++i) {
+        auto arg = [&](const char* name) { return std::strcmp(argv[i], name) == 0 && i + 1 < argc; };
+        if (arg("--size")) b.sc.size = std::atoi(argv[++i]);
+        else if (arg("--ghosts")) b.sc.ghosts = std::atoi(argv[++i]);
+        else if (arg("--bullets")) b.sc.bullets = std::atoi(argv[++i]);
+        else if (arg("--fire-every")) b.sc.fireEvery = std::atoi(argv[++i]);
+        else if (arg("--frames")) b.sc.ticks = std::atoll(argv[++i]);
+        else if (arg("--seed")) b.sc.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg("--json")) b.jsonPath = argv[++i];
+        else {
+            std::cerr << "usage: Assignment3 --bench [--size N --ghosts N --bullets N --fire-every N --frames N --seed S] [--json FILE]\n";
+            return false;
         }
-        if (GW_MAP[y][x] == 'G') {
-            GWEntity g; g.pos = { x + 0.5f, y + 0.5f };
-            ghosts.push_back(g);
-            GW_MAP[y][x] = '.';
+    }
+    b.bot.rng = b.sc.seed; b.bot.fireEvery = b.sc.fireEvery;
+    b.rng = b.sc.seed * 2654435761u;
+    return true;
+}
+
+// render target นอกจอขนาดเท่าหน้าต่าง (ไม่ขึ้นกับ default framebuffer ของหน้าต่างที่ซ่อนอยู่)
+static void gw_benchInitTarget() {
+    GWRenderBench& b = gw_bench;
+    glGenFramebuffers(1, &b.fbo);
+    glGenRenderbuffers(1, &b.colorRb);
+    glGenRenderbuffers(1, &b.depthRb);
+    glBindRenderbuffer(GL_RENDERBUFFER, b.colorRb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, GW_SCR_WIDTH, GW_SCR_HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, b.depthRb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, GW_SCR_WIDTH, GW_SCR_HEIGHT);
+    glBindFramebuffer(GL_FRAMEBUFFER, b.fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, b.colorRb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, b.depthRb);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) std::cerr << "Bench framebuffer incomplete\n";
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    b.frameMs.reserve((size_t)b.sc.ticks);
+    for (auto& v : b.cpuMs) v.reserve((size_t)b.sc.ticks);
+}
+
+// หลัง endFrame; คืน true เมื่อเก็บครบ
+static bool gw_benchRecord() {
+    GWRenderBench& b = gw_bench;
+    if (!gw_modelJobs.empty() || b.warmup-- > 0) return false;
+    const GWFrameStats& s = gw_prof.current();
+    b.frameMs.push_back(s.frameMs);
+    for (int p = 0; p < GW_PROF_CPU_COUNT; ++p) b.cpuMs[p].push_back(s.cpuMs[p]);
+    return (long long)b.frameMs.size() >= b.sc.ticks;
+}
+
+static bool gw_benchWrite(const GWWorld& w) {
+    GWRenderBench& b = gw_bench;
+    const GWFrameStats& avg = gw_prof.average();
+    GWPercentiles frame = gw_percentiles(b.frameMs);
+    GWJson j;
+    j.beginObject().value("tool", "Assignment3 --bench").value("format", 1)
+        .value("renderer", (const char*)glGetString(GL_RENDERER)).value("gl_version", (const char*)glGetString(GL_VERSION))
+        .value("width", (int)GW_SCR_WIDTH).value("height", (int)GW_SCR_HEIGHT)
+        .value("map_size", b.sc.size).value("ghosts", b.sc.ghosts).value("bullets", b.sc.bullets)
+        .value("fire_every", b.sc.fireEvery).value("frames", (long long)b.frameMs.size()).value("seed", (long long)b.sc.seed)
+        .value("ghosts_end", (long long)w.ghosts.size())
+        .value("fps", frame.mean > 0.0 ? 1000.0 / frame.mean : 0.0)
+        .value("frame_ms", frame);
+    j.beginObject("cpu_ms");
+    for (int p = 0; p < GW_PROF_CPU_COUNT; ++p) j.value(GW_PROF_CPU_NAMES[p], gw_percentiles(b.cpuMs[p]));
+    j.endObject();
+    // GPU: ค่าเฉลี่ย rolling ของ profiler (ผล query มาช้ากว่าเฟรม); -1 = ไม่มี timer query
+    j.beginObject("gpu_ms_mean");
+    for (int p = 0; p < GW_GPU_COUNT; ++p) j.value(GW_PROF_GPU_NAMES[p], avg.gpuMs[p]);
+    j.endObject();
+    j.value("draws_per_frame", (long long)avg.drawCalls).value("triangles_per_frame", (long long)avg.triangles)
+        .value("uniform_uploads_per_frame", (long long)avg.uniformUploads).value("render_sort", (int)gw_queue.sorted)
+        .value("allocs_per_frame", gw_prof.averageAllocs());
+    j.beginObject("state_changes_per_frame");
+    for (int s = 0; s < GW_STATE_COUNT; ++s) j.value(GW_PROF_STATE_NAMES[s], (long long)avg.stateChanges[s]);
+    j.endObject();
+    j.endObject();
+
+    std::printf("bench %dx%d, %d ghosts, %d bullets on %s: %.2f ms/frame (p50 %.2f, p99 %.2f) -> %.1f fps\n",
+        b.sc.size, b.sc.size, b.sc.ghosts, b.sc.bullets, (const char*)glGetString(GL_RENDERER),
+        frame.mean, frame.p50, frame.p99, frame.mean > 0.0 ? 1000.0 / frame.mean : 0.0);
+    if (!b.jsonPath) return true;
+    if (!j.save(b.jsonPath)) { std::cerr << "cannot write " << b.jsonPath << "\n"; return false; }
+    std::printf("wrote %s\n", b.jsonPath);
+    return true;
+}
+
+// ---------------- Frame capture ----------------
+// GW_CAPTURE=dir: วาดฉากลง FBO ขนาด GW_CAPTURE_SIZE (WxH, ไม่ตั้ง = ขนาดหน้าต่าง) แล้วอ่านกลับผ่าน ring ของ PBO
+// glReadPixels เข้า PBO เป็นแค่คำสั่งในคิวของ GPU; map ทีหลังเมื่อ fence ของ slot นั้นผ่านแล้ว -> ไม่รอ GPU
+// ต้องรอก็ต่อเมื่อ ring เต็มและ slot เก่าสุดยังไม่เสร็จ (นับเป็น stall); encode/เขียนไฟล์อยู่บน GWCaptureWriter
+// GW_CAPTURE_FORMAT=png|raw, GW_CAPTURE_FPS (เวลาเกมต่อเฟรม = 1/fps: วิดีโอเร็วเท่าจริงแม้วาดช้า)
+// GW_CAPTURE_FRAMES=N: หน้าต่างซ่อน + ปิดเองหลัง N เฟรม (เครื่อง build ไม่มีจอ: xvfb-run + llvmpipe)
+static const int GW_CAPTURE_RING = 3;
+
+struct GWCapture {
+    bool on = false;
+    std::string dir;
+    GWCaptureFormat format = GW_CAPTURE_PNG;
+    int w = (int)GW_SCR_WIDTH, h = (int)GW_SCR_HEIGHT;
+    float fps = 60.0f;
+    long long maxFrames = 0;
+    GLuint fbo = 0, colorRb = 0, depthRb = 0;
+    GLuint pbo[GW_CAPTURE_RING] = {};
+    GLsync fence[GW_CAPTURE_RING] = {};
+    uint64_t issued = 0, collected = 0;     // slot ของเฟรม n = n % GW_CAPTURE_RING
+    long long stalls = 0;
+    std::vector<double> overheadMs;         // ต่อเฟรม บน render thread
+    GWCaptureWriter writer;
+
+    bool hidden() const { return on && maxFrames > 0; }
+};
+static GWCapture gw_capture;
+
+static bool gw_captureParse() {
+    GWCapture& c = gw_capture;
+    const char* dir = std::getenv("GW_CAPTURE");
+    if (!dir || !*dir) return true;
+    c.on = true;
+    c.dir = dir;
+    if (const char* v = std::getenv("GW_CAPTURE_SIZE")) {
+        if (std::sscanf(v, "%dx%d", &c.w, &c.h) != 2 || c.w <= 0 || c.h <= 0) {
+            std::cerr << "GW_CAPTURE_SIZE must look like 1920x1080\n";
+            return false;
         }
     }
-    if (ghosts.empty()) { GWEntity g; g.pos = { GW_GRID_W - 2.5f, GW_GRID_H - 2.5f }; ghosts.push_back(g); }
+    if (const char* v = std::getenv("GW_CAPTURE_FORMAT")) {
+        if (std::strcmp(v, "png") == 0) c.format = GW_CAPTURE_PNG;
+        else if (std::strcmp(v, "raw") == 0) c.format = GW_CAPTURE_RAW;
+        else { std::cerr << "GW_CAPTURE_FORMAT must be png or raw\n"; return false; }
+    }
+    if (const char* v = std::getenv("GW_CAPTURE_FPS")) c.fps = std::max(1.0f, (float)std::atof(v));
+    if (const char* v = std::getenv("GW_CAPTURE_FRAMES")) c.maxFrames = std::atoll(v);
+    std::error_code ec;
+    std::filesystem::create_directories(c.dir, ec);
+    return true;
+}
+
+static bool gw_captureInit() {
+    GWCapture& c = gw_capture;
+    std::string err;
+    if (!c.writer.open(c.dir, c.format, c.w, c.h, &err)) { std::cerr << err << "\n"; return false; }
+    glGenFramebuffers(1, &c.fbo);
+    glGenRenderbuffers(1, &c.colorRb);
+    glGenRenderbuffers(1, &c.depthRb);
+    glBindRenderbuffer(GL_RENDERBUFFER, c.colorRb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, c.w, c.h);
+    glBindRenderbuffer(GL_RENDERBUFFER, c.depthRb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, c.w, c.h);
+    glBindFramebuffer(GL_FRAMEBUFFER, c.fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, c.colorRb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, c.depthRb);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) { std::cerr << "Capture framebuffer incomplete\n"; return false; }
+
+    glGenBuffers(GW_CAPTURE_RING, c.pbo);
+    for (GLuint pb : c.pbo) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pb);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)c.w * c.h * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    c.overheadMs.reserve(c.maxFrames > 0 ? (size_t)c.maxFrames : 4096);
+    std::cout << "Capturing " << c.w << "x" << c.h << " " << (c.format == GW_CAPTURE_PNG ? "png" : "raw")
+        << " at " << c.fps << " fps to " << c.dir << "\n";
+    return true;
+}
+
+// map PBO ของเฟรมที่เก่าสุดที่ยังค้าง -> copy ลง buffer ของ writer; block = รอ fence (ใช้ตอน ring เต็ม/ตอนจบ)
+static bool gw_captureCollectOne(bool block) {
+    GWCapture& c = gw_capture;
+    if (c.collected == c.issued) return false;
+    const int slot = (int)(c.collected % GW_CAPTURE_RING);
+    GLenum st = glClientWaitSync(c.fence[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (st == GL_TIMEOUT_EXPIRED && !block) return false;
+    while (st == GL_TIMEOUT_EXPIRED) st = glClientWaitSync(c.fence[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    glDeleteSync(c.fence[slot]);
+    c.fence[slot] = nullptr;
+
+    const size_t bytes = (size_t)c.w * c.h * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, c.pbo[slot]);
+    if (const void* px = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_READ_BIT)) {
+        std::vector<unsigned char>* buf = c.writer.acquire();
+        std::memcpy(buf->data(), px, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        c.writer.submit(buf);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ++c.collected;
+    return true;
+}
+
+// หลังวาดฉากลง c.fbo: ส่งเฟรมที่พร้อมแล้วให้ writer, แล้วสั่งอ่านเฟรมนี้เข้า PBO ของ slot ถัดไป
+static void gw_captureFrame() {
+    GWCapture& c = gw_capture;
+    GWProfileScope scope(&gw_prof, GW_PROF_CAPTURE);
+    GWClock::time_point t0 = GWClock::now();
+    while (gw_captureCollectOne(false)) {}
+    if (c.issued - c.collected == (uint64_t)GW_CAPTURE_RING) { ++c.stalls; gw_captureCollectOne(true); }
+
+    const int slot = (int)(c.issued % GW_CAPTURE_RING);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, c.fbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, c.pbo[slot]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, c.w, c.h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    c.fence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++c.issued;
+    c.overheadMs.push_back(gw_msSince(t0));
+}
+
+// แสดงบนหน้าต่าง: ย่อ/ขยายภาพ capture ลงหน้าต่างโดยคงสัดส่วน (แถบดำรอบข้าง)
+static void gw_capturePresent() {
+    GWCapture& c = gw_capture;
+    const float s = std::min((float)GW_SCR_WIDTH / (float)c.w, (float)GW_SCR_HEIGHT / (float)c.h);
+    const int dw = (int)(c.w * s), dh = (int)(c.h * s);
+    const int dx = ((int)GW_SCR_WIDTH - dw) / 2, dy = ((int)GW_SCR_HEIGHT - dh) / 2;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, c.fbo);
+    glBlitFramebuffer(0, 0, c.w, c.h, dx, dy, dx + dw, dy + dh, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-int main() {
-    gw_fixMapWidth();
+// อ่านเฟรมที่ค้างใน ring ให้หมด, รอ writer เขียนเสร็จ แล้วสรุป overhead
+static void gw_captureFinish() {
+    GWCapture& c = gw_capture;
+    while (gw_captureCollectOne(true)) {}
+    c.writer.close();
+    glDeleteBuffers(GW_CAPTURE_RING, c.pbo);
+    GWPercentiles o = gw_percentiles(c.overheadMs);
+    std::printf("Captured %llu frames (%.1f MB) to %s: render-thread overhead %.3f ms/frame (p50 %.3f, p99 %.3f, max %.3f), "
+        "%lld ring stalls, writer %.2f ms/frame\n",
+        (unsigned long long)c.writer.frames, c.writer.bytes / (1024.0 * 1024.0), c.dir.c_str(), o.mean, o.p50, o.p99, o.max,
+        c.stalls, c.writer.frames ? c.writer.encodeMs / (double)c.writer.frames : 0.0);
+    if (c.writer.failed) std::cerr << c.writer.failed << " capture frames could not be written\n";
+}
 
-    // ตัวแปรสถานะหลัก
-    GWEntity player; glm::vec2 playerSpawn{ 0 };
-    std::vector<GWEntity> ghosts;
-    bool hasGun = false; float fireCooldown = 0.0f; std::vector<GWBullet> bullets; bool prevSpace = false;
+int main(int argc, char** argv) {
+    // ตัวแปรสถานะหลัก (logic ทั้งหมดอยู่ใน GWWorld, รันด้วย fixed tick บน sim thread; render อ่านแค่ GWSnapshot)
+    GWWorld world;
+    GWChunkResidency residency;
+    bool prevSpace = false;
+
+    // thread ของ sim: GW_THREADS=N (ไม่ตั้ง/0 = ทุก core, 1 = thread เดียว)
+    const char* envThreads = std::getenv("GW_THREADS");
+    GWJobSystem simJobs(envThreads ? std::atoi(envThreads) : 0);
+    if (simJobs.threadCount() > 1) world.jobs = &simJobs;
+
+    // รีเกมครั้งแรก: argv[1] = ไฟล์ .gwl (ดู tools/gw_levelconv.cpp) หรือ --bench, ไม่ระบุ = แผนที่ในตัว
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        if (!gw_benchParse(argc, argv)) return -1;
+        world.load(gw_makeMaze(gw_bench.sc.size, gw_bench.sc.size, gw_bench.sc.seed));
+        world.reserve((size_t)gw_bench.sc.ghosts, (size_t)gw_bench.sc.bullets + GW_PLAYER_BULLETS);
+        gw_bench.open = gw_openTiles(world.grid);
+    }
+    else if (argc > 1) {
+        GWGrid grid;
+        std::string err;
+        if (!gw_openLevelFile(argv[1], grid, &err)) { std::cerr << err << "\n"; return -1; }
+        world.load(std::move(grid));
+    }
+    else world.load(GW_DEFAULT_MAP);
+
+    // GW_RECORD=file.gwr: อัด input ทุก tick ตั้งแต่ tick แรก (เล่นซ้ำด้วย tools/gw_headless --replay)
+    GWReplayWriter recorder;
+    if (const char* recPath = std::getenv("GW_RECORD"); recPath && !gw_bench.on) {
+        std::string err, mapPath;
+        if (argc > 1) mapPath = std::filesystem::absolute(argv[1]).string();
+        if (recorder.open(recPath, world, mapPath, 0, GW_SIM_DT, &err)) std::cout << "Recording input to " << recPath << "\n";
+        else std::cerr << err << "\n";
+    }
 
-    // รีเกมครั้งแรก
-    gw_resetGame(player, playerSpawn, ghosts, bullets, hasGun, fireCooldown);
+    // GW_CAPTURE: บันทึกเฟรมลงไฟล์ (ไม่ใช้กับ --bench)
+    if (!gw_bench.on && !gw_captureParse()) return -1;
 
     // --- GL init ---
     glfwInit();
@@ -369,29 +1622,52 @@ int main() {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (gw_bench.on || gw_capture.hidden()) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
     GLFWwindow* win = glfwCreateWindow(GW_SCR_WIDTH, GW_SCR_HEIGHT, "Assignment3", nullptr, nullptr);
     if (!win) { std::cerr << "GLFW window fail\n"; glfwTerminate(); return -1; }
     glfwMakeContextCurrent(win);
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { std::cerr << "GLAD fail\n"; return -1; }
     glEnable(GL_DEPTH_TEST);
-
-    gw_colorProg = gw_makeProgram(GW_COLOR_VS, GW_COLOR_FS);
+    if (gw_bench.on) { glfwSwapInterval(0); gw_benchInitTarget(); }
+    if (gw_capture.on && !gw_captureInit()) { glfwTerminate(); return -1; }
+
+    gw_initFrameUBO();
+    // Programs (binary cache ข้าง model cache)
+    gw_programCacheInit(FileSystem::getPath("resources/cache/programs"));
+    gw_colorProg = gw_resolveProgram(gw_makeProgram("color", GW_COLOR_VS, GW_COLOR_FS));
+    gw_colorInstProg = gw_resolveProgram(gw_makeProgram("color_inst", GW_COLOR_INST_VS, GW_COLOR_FS));
+    gw_wallProg = gw_resolveProgram(gw_makeProgram("wall", GW_WALL_VS, GW_COLOR_FS, "#define GW_CHECKER\n"));
+    gw_modelProg = gw_resolveProgram(gw_makeProgramFiles("model", "1.model_loading.vs", "1.model_loading.fs"));
+    gw_modelInstProg = gw_resolveProgram(gw_makeProgram("model_inst", GW_MODEL_INST_VS, GW_MODEL_FS));
+    if (!gw_colorProg.id || !gw_colorInstProg.id || !gw_wallProg.id || !gw_modelProg.id || !gw_modelInstProg.id) {
+        std::cerr << "Shader program build failed\n";
+        glfwTerminate();
+        return -1;
+    }
+    std::cout << "Programs: " << gw_programs.programs << " ready in " << gw_programs.ms << " ms ("
+        << (gw_programs.enabled ? std::to_string(gw_programs.hits) + " from binary cache)" : std::string("cache off)")) << "\n";
+    for (const GWProgram* p : { &gw_modelInstProg, &gw_modelProg }) {
+        gw_useProgram(p->id);
+        glUniform1i(glGetUniformLocation(p->id, "texture_diffuse1"), 0);
+    }
     gw_initCube();
     gw_initSphere();
 
-    // Model shader + models
-    Shader modelShader("1.model_loading.vs", "1.model_loading.fs");
-    Model duck(FileSystem::getPath("resources/objects/duck2/duck.obj"));
-    Model rock(FileSystem::getPath("resources/objects/rock/rock.obj"));
-    Model gun(FileSystem::getPath("resources/objects/gun/gun.obj"));
-    Model& playerModel = duck;
-    Model& ghostModel = rock;
-    Model& gunModel = gun;
+    // Models
+    // โหลดบน worker; ระหว่างนี้เกมเริ่มเลยและวาด placeholder
+    GWModel duck, rock, gun;
+    gw_requestModel(duck, FileSystem::getPath("resources/objects/duck2/duck.obj"), FileSystem::getPath("resources/cache/duck.gwm"), glm::vec3(0.5f));
+    gw_requestModel(rock, FileSystem::getPath("resources/objects/rock/rock.obj"), FileSystem::getPath("resources/cache/rock.gwm"), glm::vec3(0.6f));
+    gw_requestModel(gun, FileSystem::getPath("resources/objects/gun/gun.obj"), FileSystem::getPath("resources/cache/gun.gwm"), glm::vec3(0.3f, 0.15f, 0.3f));
+    const GWModel& playerModel = duck;
+    const GWModel& ghostModel = rock;
+    const GWModel& gunModel = gun;
+    gw_initEntityRenderer(ghostModel);
 
     // Camera (Top-only)
     float camPitch = -58.0f; // ค่าตั้งต้นปรับให้สูงขึ้นเล็กน้อย
     float camDist = glm::length(glm::vec2(5.0f, 7.0f));
-    float camYaw = 180.0f + player.yaw;
+    float camYaw = 180.0f + world.player.yaw;     // ก่อน sim thread เริ่ม: อ่าน world ตรงๆ ได้
     const float CAM_PITCH_MIN = -89.0f, CAM_PITCH_MAX = -10.0f;
 
     double lastMX = 0.0, lastMY = 0.0; bool rotating = false, rmbPrimed = false;
@@ -400,9 +1676,38 @@ int main() {
     GW_camDistPtr = &camDist;
     glfwSetScrollCallback(win, gw_scroll_callback);
 
+    // Profiler: HUD บน title bar เสมอ; GW_PROFILE=1 พิมพ์สรุปทุกวินาที, GW_PROFILE_CSV=path เขียนทุกเฟรม
+    // เฟสของ sim จับบน thread ของ sim แล้วบวกผลต่างจาก snapshot เข้า gw_prof ทุกเฟรม
+    gw_gpuTimersInit();
+    gw_queueInit();
+    const bool profConsole = std::getenv("GW_PROFILE") && std::atoi(std::getenv("GW_PROFILE")) != 0;
+    if (const char* csv = std::getenv("GW_PROFILE_CSV")) {
+        if (gw_prof.openCsv(csv)) std::cout << "Profiler CSV: " << csv << "\n";
+        else std::cerr << "Cannot write profiler CSV " << csv << "\n";
+    }
+    double lastHud = 0.0, lastConsole = 0.0;
+
+    // Simulation: thread แยกที่ 60 Hz; --bench, GW_CAPTURE และ GW_SIM_THREAD=0 เดินแบบ inline บน thread นี้
+    // (bench เติมผี/กระสุนและสุ่ม input จาก world ทุกเฟรม, capture เดินเวลาเกมทีละ 1/fps ต่อเฟรม จึงต้อง inline)
+    GWSimRunner sim(world);
+    sim.onTick = [&recorder](const GWInputState& ti, const GWWorld& w) { recorder.tick(ti, w); };
+    const char* envSimThread = std::getenv("GW_SIM_THREAD");
+    if (!gw_bench.on && !gw_capture.on && !(envSimThread && std::atoi(envSimThread) == 0)) sim.start();
+    std::cout << "Simulation: " << (sim.threaded() ? "own thread" : "inline") << "\n";
+    GWSnapshot seen;    // ตัวนับ/เวลาเฟสของ snapshot ก่อนหน้า (หาผลต่าง)
+
+    // ปลายทางของฉาก: FBO ของ capture (ขนาดที่ตั้ง) / bench (นอกจอ) / หน้าต่าง (0)
+    const GLuint sceneFbo = gw_capture.on ? gw_capture.fbo : gw_bench.fbo;
+    const int sceneW = gw_capture.on ? gw_capture.w : (int)GW_SCR_WIDTH;
+    const int sceneH = gw_capture.on ? gw_capture.h : (int)GW_SCR_HEIGHT;
+
     double last = glfwGetTime();
+    bool firstFrameShown = false;
     while (!glfwWindowShouldClose(win)) {
+        gw_prof.beginFrame();
+        const unsigned long long allocs0 = gw_allocCount();   // ทุก thread (รวม sim) ระหว่างเฟรมนี้
         double now = glfwGetTime(); float dt = float(now - last); last = now;
+        GWProfileScope inputScope(&gw_prof, GW_PROF_INPUT);
         glfwPollEvents();
 
         // RMB orbit
@@ -437,163 +1742,41 @@ int main() {
             }
         }
 
-        // Player movement (tile-by-tile) + pre-turn
-        {
-            glm::ivec2 in = gw_readInput(win);
-            if (in != glm::ivec2(0)) player.ctrl.queued = in;
-
-            auto apply_dir = [&](const glm::ivec2& d) {
-                player.ctrl.dir = d;
-                if (d == glm::ivec2(1, 0))      player.yaw = 0.f;
-                else if (d == glm::ivec2(-1, 0)) player.yaw = 180.f;
-                else if (d == glm::ivec2(0, 1))  player.yaw = 90.f;
-                else if (d == glm::ivec2(0, -1)) player.yaw = -90.f;
-                };
-
-            if (!player.ctrl.moving && player.ctrl.queued != glm::ivec2(0)) {
-                glm::ivec2 t = { (int)std::floor(player.pos.x), (int)std::floor(player.pos.y) };
-                glm::ivec2 nt = t + player.ctrl.queued;
-                if (!gw_wallAt(nt.x, nt.y)) {
-                    apply_dir(player.ctrl.queued);
-                    player.ctrl.target = gw_centerOf(nt);
-                    player.ctrl.moving = true;
-                }
-            }
-
-            if (player.ctrl.moving && player.ctrl.queued != glm::ivec2(0) && player.ctrl.queued != player.ctrl.dir) {
-                bool orthogonal = (player.ctrl.queued.x == 0 && player.ctrl.dir.x != 0) ||
-                    (player.ctrl.queued.y == 0 && player.ctrl.dir.y != 0);
-                if (orthogonal) {
-                    glm::ivec2 t = { (int)std::floor(player.pos.x), (int)std::floor(player.pos.y) };
-                    glm::vec2  center = gw_centerOf(t);
-
-                    glm::ivec2 turnTo = t + player.ctrl.queued;
-                    if (!gw_wallAt(turnTo.x, turnTo.y)) {
-                        const float TURN_SNAP = 0.20f;
-                        glm::vec2  toC = center - player.pos;
-                        float      distC = glm::length(toC);
-
-                        float step = GW_STEP_SPEED_PLAYER * dt;
-                        bool willCrossCenter = (distC <= step + 1e-4f);
-
-                        if (distC <= TURN_SNAP || willCrossCenter) {
-                            player.pos = center;
-                            apply_dir(player.ctrl.queued);
-                            player.ctrl.target = gw_centerOf(turnTo);
-                            player.ctrl.moving = true;
-                        }
-                    }
-                }
-            }
-
-            if (player.ctrl.moving) {
-                glm::vec2 to = player.ctrl.target - player.pos;
-                float dist = glm::length(to);
-                if (dist < 1e-4f) {
-                    player.pos = player.ctrl.target;
-                    player.ctrl.moving = false;
-                }
-                else {
-                    glm::vec2 v = (to / std::max(dist, 1e-6f)) * GW_STEP_SPEED_PLAYER;
-                    float step = GW_STEP_SPEED_PLAYER * dt;
-                    if (step >= dist) { player.pos = player.ctrl.target; player.ctrl.moving = false; }
-                    else player.pos += v * dt;
-                }
-            }
-
-            // gun pickup
-            glm::ivec2 pt = { (int)std::floor(player.pos.x), (int)std::floor(player.pos.y) };
-            if (pt.x >= 0 && pt.x < GW_GRID_W && pt.y >= 0 && pt.y < GW_GRID_H && GW_MAP[pt.y][pt.x] == 'K') {
-                hasGun = true; GW_MAP[pt.y][pt.x] = '.'; std::cout << "Picked up gun!\n";
-            }
-        }
-
-        // Shooting
-        {
-            bool spaceNow = (glfwGetKey(win, GLFW_KEY_SPACE) == GLFW_PRESS);
-            if (spaceNow && !prevSpace) {
-                if (hasGun && fireCooldown <= 0.0f) {
-                    glm::vec2 shootDir(0, -1);
-                    if (player.ctrl.dir != glm::ivec2(0)) shootDir = glm::vec2((float)player.ctrl.dir.x, (float)player.ctrl.dir.y);
-                    else {
-                        if (fabs(player.yaw - 0.f) < 1e-3f)        shootDir = { 1, 0 };
-                        else if (fabs(player.yaw - 180.f) < 1e-1f) shootDir = { -1, 0 };
-                        else if (fabs(player.yaw - 90.f) < 1e-1f)  shootDir = { 0, 1 };
-                        else if (fabs(player.yaw + 90.f) < 1e-1f)  shootDir = { 0,-1 };
-                    }
-                    if (glm::length(shootDir) > 0.0f) {
-                        bullets.push_back(GWBullet{ player.pos, glm::normalize(shootDir), 1.5f, true });
-                        fireCooldown = GW_FIRE_COOLDOWN;
-                    }
-                }
-            }
-            prevSpace = spaceNow;
-        }
-
-        // Ghosts
-        glm::ivec2 playerTile = { (int)std::floor(player.pos.x), (int)std::floor(player.pos.y) };
-        for (auto& g : ghosts) {
-            glm::ivec2 gt = { (int)std::floor(g.pos.x), (int)std::floor(g.pos.y) };
-            if (!g.ctrl.moving) {
-                glm::ivec2 ndir = gw_chooseDirChase(gt, g.ctrl.dir, playerTile);
-                if (ndir != glm::ivec2(0)) {
-                    g.ctrl.dir = ndir;
-                    g.ctrl.target = gw_centerOf(gt + ndir);
-                    g.ctrl.moving = true;
-                    if (g.ctrl.dir == glm::ivec2(1, 0))  g.yaw = 0.f;
-                    else if (g.ctrl.dir == glm::ivec2(-1, 0)) g.yaw = 180.f;
-                    else if (g.ctrl.dir == glm::ivec2(0, 1))  g.yaw = 90.f;
-                    else if (g.ctrl.dir == glm::ivec2(0, -1)) g.yaw = -90.f;
-                }
-            }
-            if (g.ctrl.moving) {
-                glm::vec2 to = g.ctrl.target - g.pos;
-                float dist = glm::length(to);
-                if (dist < 1e-4f) { g.pos = g.ctrl.target; g.ctrl.moving = false; }
-                else {
-                    glm::vec2 v = (to / dist) * GW_STEP_SPEED_ENEMY;
-                    float step = GW_STEP_SPEED_ENEMY * dt;
-                    if (step >= dist) { g.pos = g.ctrl.target; g.ctrl.moving = false; }
-                    else g.pos += v * dt;
-                }
-            }
-        }
-
-        // Bullets update
-        for (auto& b : bullets) {
-            if (!b.alive) continue;
-            b.pos += b.dir * GW_BULLET_SPEED * dt;
-            b.life -= dt;
-            if (b.life <= 0.0f) b.alive = false;
-            glm::ivec2 bt = { (int)std::floor(b.pos.x), (int)std::floor(b.pos.y) };
-            if (bt.x < 0 || bt.x >= GW_GRID_W || bt.y < 0 || bt.y >= GW_GRID_H || gw_wallAt(bt.x, bt.y)) b.alive = false;
-        }
-        bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [](const GWBullet& x) {return !x.alive; }), bullets.end());
-
-        // Bullet vs Ghost
-        for (auto itg = ghosts.begin(); itg != ghosts.end();) {
-            bool killed = false;
-            for (auto& b : bullets) {
-                if (!b.alive) continue;
-                if (glm::length(b.pos - itg->pos) < 0.7f) { b.alive = false; killed = true; break; }
-            }
-            if (killed) { std::cout << "Ghost shot!\n"; itg = ghosts.erase(itg); }
-            else ++itg;
-        }
-
-        // Player vs Ghost — รีเกมทั้งกระดาน + ปืนเกิดใหม่
-        bool collided = false;
-        for (auto& g : ghosts) {
-            if (glm::length(g.pos - player.pos) < 0.55f) { collided = true; break; }
-        }
-        if (collided) {
-            std::cout << "Caught! Restart game.\n";
-            gw_resetGame(player, playerSpawn, ghosts, bullets, hasGun, fireCooldown);
-            // ไม่ยุ่งกับมุมกล้อง เพื่อไม่ให้เวียนหัวตอนรีเกม
+        // Input -> sim (queue) หรือ fixed ticks (inline)
+        GWInputState in;
+        in.dir = gw_readInput(win);
+        bool spaceNow = (glfwGetKey(win, GLFW_KEY_SPACE) == GLFW_PRESS);
+        in.fire = spaceNow && !prevSpace;
+        prevSpace = spaceNow;
+        if (gw_bench.on) {
+            gw_benchTopUp(world, gw_bench.sc, gw_bench.open, gw_bench.rng);
+            world.hasGun = gw_bench.sc.fireEvery > 0;
+            in = gw_bench.bot.sample(world);
+            dt = GW_SIM_DT;
         }
+        if (gw_capture.on) dt = 1.0f / gw_capture.fps;
+        if (sim.threaded()) sim.pushInput(in);
+        inputScope.stop();
+
+        if (!sim.threaded()) sim.advanceInline(dt, in);
+        const GWSnapshot& snap = sim.latest();
+        for (int p = 0; p < GW_PROF_CPU_COUNT; ++p) gw_prof.addCpu((GWProfPhase)p, snap.simMs[p] - seen.simMs[p]);
+        if (snap.gunsPicked != seen.gunsPicked) std::cout << "Picked up gun!\n";
+        for (uint64_t i = seen.ghostsShot; i < snap.ghostsShot; ++i) std::cout << "Ghost shot!\n";
+        if (snap.caught != seen.caught) std::cout << "Caught! Restart game.\n"; // ไม่ยุ่งกับมุมกล้อง เพื่อไม่ให้เวียนหัวตอนรีเกม
+        seen.gunsPicked = snap.gunsPicked; seen.ghostsShot = snap.ghostsShot; seen.caught = snap.caught;
+        std::copy(snap.simMs, snap.simMs + GW_PROF_CPU_COUNT, seen.simMs);
+        residency.update(world.grid, gw_tileOf(snap.playerPos), GW_LEVEL_RESIDENT_RADIUS);
+        gw_levelSync(world, snap.playerPos);
+        gw_pumpModelUploads();
+
+        // สถานะสำหรับวาด: interpolate ระหว่าง tick ก่อนหน้ากับ tick ของ snapshot
+        const float alpha = sim.alpha(snap);
+        glm::vec2 playerPos = gw_lerpPos(snap.playerPrev, snap.playerPos, alpha);
 
         // Camera
-        glm::vec3 target = { player.pos.x, 0.7f, player.pos.y };
+        GWProfileScope cameraScope(&gw_prof, GW_PROF_CAMERA);
+        glm::vec3 target = { playerPos.x, 0.7f, playerPos.y };
         float yawRad = glm::radians(camYaw), pitchRad = glm::radians(camPitch);
         glm::vec3 dir;
         dir.x = std::cos(pitchRad) * std::sin(yawRad);
@@ -602,45 +1785,39 @@ int main() {
         glm::vec3 camPos = target - dir * camDist;
 
         glm::mat4 V = glm::lookAt(camPos, target, { 0,1,0 });
-        glm::mat4 P = glm::perspective(glm::radians(55.f), (float)GW_SCR_WIDTH / (float)GW_SCR_HEIGHT, 0.1f, 200.f);
+        glm::mat4 P = glm::perspective(glm::radians(55.f), (float)sceneW / (float)sceneH, 0.1f, 200.f);
+        cameraScope.stop();
 
         // ===== Render =====
-        glViewport(0, 0, GW_SCR_WIDTH, GW_SCR_HEIGHT);
+        GWProfileScope renderScope(&gw_prof, GW_PROF_RENDER);
+        gw_gpuFrameBegin(gw_prof.frame());
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo);
+        glViewport(0, 0, sceneW, sceneH);
         glClearColor(0.25f, 0.85f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gw_setFrameUniforms(V, P);
+        gw_cullLevel(P * V, camPos);
+        gw_queueBegin(camPos, 200.f);
 
         // ===== Floor (checkerboard) + Walls (alternate color) + Gun =====
-        for (int y = 0; y < GW_GRID_H; ++y) {
-            for (int x = 0; x < GW_GRID_W; ++x) {
-                char c = GW_MAP[y][x];
-
-                // พื้น: สร้างเป็น tile เตี้ยๆ (ความสูง 0.02) สีสลับแบบหมากรุก
-                {
-                    bool alt = ((x + y) & 1);
-                    glm::vec3 floorColor = alt ? glm::vec3(0.08f, 0.09f, 0.13f)
-                        : glm::vec3(0.10f, 0.12f, 0.16f);
-                    gw_drawCube(V, P, { x + 0.5f, -0.01f, y + 0.5f }, { 1, 0.02f, 1 }, floorColor);
-                }
-
-                // ผนัง: สลับ 2 เฉดเพื่อให้เห็นทางชัดขึ้น
-                if (c == '#') {
-                    bool alt = ((x + y) & 1);
-                    glm::vec3 wallColor = alt ? glm::vec3(0.12f, 0.35f, 0.85f)
-                        : glm::vec3(0.10f, 0.30f, 0.76f);
-                    gw_drawCube(V, P, { x + 0.5f, 0.5f, y + 0.5f }, { 1, 1, 1 }, wallColor);
-                }
-                else if (c == 'K') {
-                    // ปืน: วางโมเดลไว้บนพื้น
-                    glm::vec3 gp = { x + 0.5f, 0.15f, y + 0.5f };
-                    gw_drawModel(modelShader, gunModel, V, P, gp, glm::vec3(0.0012f), 0.f, -90.f, 0.f);
-                }
+        gw_drawLevel();
+        // ปืน: เฉพาะของ chunk ที่เห็น (ไม่ไล่ตารางปืนทั้งแผนที่)
+        for (uint32_t ci : gw_vis.visible) {
+            const GWLevelChunk& c = gw_level.chunks[ci];
+            for (uint32_t j = c.keyFirst; j < c.keyFirst + c.keyCount; ++j) {
+                const uint32_t i = gw_level.keys[j];
+                if (snap.keyTaken[i]) continue; // เก็บไปแล้ว
+                const glm::ivec2& k = world.grid.keys[i];
+                // ปืน: วางโมเดลไว้บนพื้น
+                glm::vec3 gp = { k.x + 0.5f, 0.15f, k.y + 0.5f };
+                gw_drawModel(gunModel, gp, glm::vec3(0.0012f), 0.f, -90.f, 0.f);
             }
         }
 
         // Player model (ปรับ yaw ให้หันถูกทิศ)
-        float faceYaw = (player.ctrl.dir.y != 0) ? (player.yaw - 90.f) : (player.yaw + 90.f);
-        gw_drawModel(modelShader, playerModel, V, P,
-            { player.pos.x, 0.15f, player.pos.y },
+        float faceYaw = (snap.playerDir.y != 0) ? (snap.playerYaw - 90.f) : (snap.playerYaw + 90.f);
+        gw_drawModel(playerModel,
+            { playerPos.x, 0.15f, playerPos.y },
             glm::vec3(1.0f),
             faceYaw, 0.f, 0.f);
 
@@ -649,25 +1826,77 @@ int main() {
         const float     GHOST_Y = 0.25f;            // ยกจากพื้นเล็กน้อย
         const float     GHOST_PIT = 0.0f;             // ไม่ต้องก้ม
 
-        for (auto& g : ghosts) {
-            gw_drawModel(modelShader, ghostModel, V, P,
-                { g.pos.x, GHOST_Y, g.pos.y },
-                GHOST_SCL,
-                g.yaw, GHOST_PIT, 0.f);
+        GWEntityRenderer& er = gw_entities;
+        er.ghostInst.clear(); er.sphereInst.clear();
+        for (size_t i = 0; i < snap.ghostCount(); ++i) {
+            glm::vec2 gp = snap.ghostPos(i, alpha);
+            if (!gw_chunkVisibleAt(gp)) continue;
+            if (ghostModel.ready) {
+                GWInstance gi;
+                gi.model = gw_modelMatrix({ gp.x, GHOST_Y, gp.y }, GHOST_SCL, snap.ghostYaw[i], GHOST_PIT, 0.f);
+                er.ghostInst.push_back(gi);
+            }
+            else {
+                // placeholder ระหว่างโหลด rock: ทรงกลมสีเทา (instanced เหมือนกระสุน)
+                GWInstance ph;
+                ph.model = glm::scale(glm::translate(glm::mat4(1.f), { gp.x, GHOST_Y + 0.10f, gp.y }), glm::vec3(0.30f));
+                ph.color = { 0.45f, 0.45f, 0.5f, 1.f };
+                er.sphereInst.push_back(ph);
+            }
 
             // “แกนพลัง” สีเหลืองด้านใน
-            gw_drawSphere(V, P, { g.pos.x, GHOST_Y + 0.10f, g.pos.y }, 0.10f, { 0.9f, 0.85f, 0.2f });
+            GWInstance core;
+            core.model = glm::scale(glm::translate(glm::mat4(1.f), { gp.x, GHOST_Y + 0.10f, gp.y }), glm::vec3(0.10f));
+            core.color = { 0.9f, 0.85f, 0.2f, 1.f };
+            er.sphereInst.push_back(core);
         }
 
         // Bullets — spheres
-        for (auto& b : bullets)
-            gw_drawSphere(V, P, { b.pos.x, 0.10f, b.pos.y }, 0.08f, { 1.0f, 0.95f, 0.2f });
+        for (size_t i = 0; i < snap.bulletCount(); ++i) {
+            glm::vec2 bp = snap.bulletPos(i, alpha);
+            if (!gw_chunkVisibleAt(bp)) continue;
+            GWInstance bi;
+            bi.model = glm::scale(glm::translate(glm::mat4(1.f), { bp.x, 0.10f, bp.y }), glm::vec3(0.08f));
+            bi.color = { 1.0f, 0.95f, 0.2f, 1.f };
+            er.sphereInst.push_back(bi);
+        }
+        gw_drawEntities();
+        gw_queueFlush();
+        renderScope.stop();
 
-        if (fireCooldown > 0.0f) fireCooldown -= dt;
+        if (gw_capture.on) {
+            gw_captureFrame();
+            if (!gw_capture.hidden()) gw_capturePresent();
+        }
+        if (gw_bench.on) glFinish();
+        else if (!gw_capture.hidden()) glfwSwapBuffers(win);
+        if (!firstFrameShown) {
+            firstFrameShown = true;
+            std::cout << "First frame after " << gw_msSince(gw_startTime) << " ms\n";
+        }
+        gw_prof.countAllocs(gw_allocCount() - allocs0);
+        gw_prof.endFrame();
+        if (gw_bench.on && gw_benchRecord()) {
+            bool ok = gw_benchWrite(world);
+            glfwTerminate();
+            return ok ? 0 : -1;
+        }
+
+        if (gw_capture.hidden() && (long long)gw_capture.issued >= gw_capture.maxFrames) glfwSetWindowShouldClose(win, GLFW_TRUE);
 
-        glfwSwapBuffers(win);
+        if (now - lastHud >= 0.5) {
+            lastHud = now;
+            glfwSetWindowTitle(win, ("Assignment3 | " + gw_prof.summary()).c_str());
+        }
+        if (profConsole && now - lastConsole >= 1.0) {
+            lastConsole = now;
+            std::cout << "[prof] " << gw_prof.summary() << "\n";
+        }
     }
 
+    sim.stop();     // tick สุดท้ายเขียนลง recorder ก่อนปิด
+    if (gw_capture.on) gw_captureFinish();
+    if (recorder.active()) std::cout << "Recorded " << recorder.ticks() << " ticks\n";
     glfwTerminate();
     return 0;
 }
@@ -6,8 +6,15 @@ layout (location = 2) in vec2 aTexCoords;
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-frame block (ต้องตรงกับ GW_FRAME_GLSL ใน .cpp)
+layout (std140) uniform GWFrame
+{
+    mat4 view;
+    mat4 projection;
+    vec4 fogColor;
+    vec4 fogParams;
+};
 
 void main()
 {
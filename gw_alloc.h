@@ -0,0 +1,36 @@
+// Grid Walk 3D — heap allocation counter
+// แทน operator new ทั้งโปรแกรม: นับทุกครั้งจากทุก thread (รวม worker ของ job system) ด้วย atomic แบบ relaxed
+// include ใน .cpp เดียวของแต่ละโปรแกรมเท่านั้น (operator new นิยามซ้ำ = link error)
+// ใช้: a0 = gw_allocCount(); ...; gw_allocCount() - a0 = จำนวน allocation ในช่วงนั้น
+// ไม่มี GL ในไฟล์นี้
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<unsigned long long> gw_allocs{ 0 };
+
+static inline unsigned long long gw_allocCount() { return gw_allocs.load(std::memory_order_relaxed); }
+
+// GCC >= 11 มองเห็นทั้ง new (malloc) และ delete (free) ใน TU เดียว แล้วเตือน mismatched ผิดๆ หลัง inline
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t n) {
+    gw_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,182 @@
+// Grid Walk 3D — benchmark scenarios (ใช้ร่วมกันระหว่าง tools/gw_bench, tools/gw_headless และ --bench ของเกม)
+// maze แบบ procedural ตามขนาด, ผี/กระสุนคงจำนวน, bot ที่ยิงตามอัตรา, percentile และ JSON writer
+// ไม่มี GL ในไฟล์นี้
+
+#pragma once
+
+#include "gw_world.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Scripted player: random held direction, fires every fireEvery ticks (deterministic per seed)
+struct GWBot {
+    uint32_t rng = 1;
+    int fireEvery = 15;                 // 0 = ไม่ยิง
+    glm::ivec2 dir{ 0,0 };
+    int hold = 0;
+
+    uint32_t next() { rng = rng * 1664525u + 1013904223u; return rng >> 8; }
+
+    GWInputState sample(const GWWorld& w) {
+        static const glm::ivec2 DIRS[4] = { {1,0},{-1,0},{0,1},{0,-1} };
+        if (--hold <= 0) { dir = DIRS[next() & 3]; hold = 10 + (int)(next() % 50); }
+        GWInputState in;
+        in.dir = dir;
+        in.fire = fireEvery > 0 && (w.tick % (uint64_t)fireEvery) == 0;
+        return in;
+    }
+};
+
+// ---------------- Procedural maze ----------------
+// recursive backtracker บน cell ที่พิกัดคี่ (stack แบบ explicit: 2048x2048 ไม่ล้น call stack)
+// แล้วเจาะผนังเพิ่ม ~1/8 ของ cell ให้มีวง (ผีไล่ได้หลายทาง); P มุมซ้ายบน, G/K กระจายตามขนาด
+static inline std::vector<std::string> gw_makeMaze(int w, int h, uint32_t seed) {
+    w = std::max(w, 5); h = std::max(h, 5);
+    std::vector<std::string> m((size_t)h, std::string((size_t)w, '#'));
+    const int cw = (w - 1) / 2, ch = (h - 1) / 2;       // cell (i,j) อยู่ที่ tile (2i+1, 2j+1)
+    auto rnd = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    auto at = [&m](int cx, int cy) -> char& { return m[(size_t)(2 * cy + 1)][(size_t)(2 * cx + 1)]; };
+
+    std::vector<uint32_t> stack;
+    stack.reserve((size_t)cw * ch);
+    stack.push_back(0);
+    at(0, 0) = '.';
+    static const int DX[4] = { 1, -1, 0, 0 }, DY[4] = { 0, 0, 1, -1 };
+    while (!stack.empty()) {
+        uint32_t c = stack.back();
+        int cx = (int)(c % (uint32_t)cw), cy = (int)(c / (uint32_t)cw);
+        int opts[4], n = 0;
+        for (int d = 0; d < 4; ++d) {
+            int nx = cx + DX[d], ny = cy + DY[d];
+            if (nx >= 0 && ny >= 0 && nx < cw && ny < ch && at(nx, ny) == '#') opts[n++] = d;
+        }
+        if (n == 0) { stack.pop_back(); continue; }
+        int d = opts[rnd() % (uint32_t)n];
+        int nx = cx + DX[d], ny = cy + DY[d];
+        m[(size_t)(2 * cy + 1 + DY[d])][(size_t)(2 * cx + 1 + DX[d])] = '.';
+        at(nx, ny) = '.';
+        stack.push_back((uint32_t)(ny * cw + nx));
+    }
+    // braid: ผนังระหว่าง cell สองช่องที่เปิดอยู่
+    for (size_t i = 0, loops = (size_t)cw * ch / 8; i < loops; ++i) {
+        int x = 1 + (int)(rnd() % (uint32_t)(w - 2)), y = 1 + (int)(rnd() % (uint32_t)(h - 2));
+        if (m[y][x] != '#') continue;
+        bool horiz = m[y][x - 1] != '#' && m[y][x + 1] != '#';
+        bool vert = m[y - 1][x] != '#' && m[y + 1][x] != '#';
+        if (horiz != vert) m[y][x] = '.';
+    }
+
+    auto randomCell = [&]() { return glm::ivec2(2 * (int)(rnd() % (uint32_t)cw) + 1, 2 * (int)(rnd() % (uint32_t)ch) + 1); };
+    m[1][1] = 'P';
+    m[(size_t)(2 * ch - 1)][(size_t)(2 * cw - 1)] = 'G';
+    const size_t cells = (size_t)cw * ch;
+    for (size_t i = 1; i < std::max<size_t>(1, cells / 4000); ++i) {
+        glm::ivec2 t = randomCell();
+        if (m[t.y][t.x] == '.' && t.x + t.y > 8) m[t.y][t.x] = 'G';
+    }
+    for (size_t i = 0; i < std::max<size_t>(1, cells / 2000); ++i) {
+        glm::ivec2 t = randomCell();
+        if (m[t.y][t.x] == '.') m[t.y][t.x] = 'K';
+    }
+    return m;
+}
+
+// ---------------- Scenario ----------------
+struct GWBenchScenario {
+    std::string name;
+    int size = 15;              // maze size x size
+    int ghosts = 0;             // ผีที่รักษาไว้ตลอด (0 = เท่าที่แผนที่มี)
+    int bullets = 0;            // กระสุนที่ยังบินอยู่ขั้นต่ำ (เติมจาก tile ว่างแบบสุ่ม)
+    int fireEvery = 15;         // ผู้เล่นถือปืนตลอดและยิงทุกกี่ tick (0 = ไม่ยิง)
+    long long ticks = 20000;
+    uint32_t seed = 1;
+};
+
+// tile ว่างทั้งหมด (ใช้สุ่มจุดเกิดของผี/กระสุนที่เติม)
+static inline std::vector<glm::ivec2> gw_openTiles(const GWGrid& g) {
+    std::vector<glm::ivec2> open;
+    for (int y = 0; y < g.h; ++y)
+        for (int x = 0; x < g.w; ++x)
+            if (!g.wall(x, y)) open.push_back({ x, y });
+    return open;
+}
+
+// เติมผี/กระสุนให้ถึงจำนวนของ scenario (เรียกนอกช่วงจับเวลา step); ผีเกิดห่างผู้เล่นอย่างน้อย 5 tile
+// spawn ใช้ capacity/free slot เดิม: หลัง warm-up ไม่ allocate
+static inline void gw_benchTopUp(GWWorld& w, const GWBenchScenario& sc, const std::vector<glm::ivec2>& open, uint32_t& rng) {
+    if (open.empty()) return;
+    auto pick = [&]() { rng = rng * 1664525u + 1013904223u; return open[(rng >> 8) % open.size()]; };
+    const glm::ivec2 pt = gw_tileOf(w.player.pos);
+    for (int tries = 0; (int)w.ghosts.size() < sc.ghosts && tries < 4 * sc.ghosts; ++tries) {
+        glm::ivec2 t = pick();
+        glm::ivec2 d = glm::abs(t - pt);
+        if (d.x + d.y > 4) w.ghosts.spawn(gw_centerOf(t));
+    }
+    static const glm::vec2 DIRS[4] = { {1,0},{-1,0},{0,1},{0,-1} };
+    while ((int)w.bullets.live < sc.bullets)
+        w.bullets.spawn(gw_centerOf(pick()), DIRS[(rng >> 4) & 3], 1.5f);
+}
+
+// ---------------- Statistics ----------------
+struct GWPercentiles {
+    double mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+// เรียงใน samples เอง (nearest-rank)
+static inline GWPercentiles gw_percentiles(std::vector<double>& samples) {
+    GWPercentiles r;
+    if (samples.empty()) return r;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    auto rank = [&samples](double p) { return samples[std::min(samples.size() - 1, (size_t)(p * (double)samples.size()))]; };
+    r.mean = sum / (double)samples.size();
+    r.p50 = rank(0.50); r.p90 = rank(0.90); r.p99 = rank(0.99);
+    r.max = samples.back();
+    return r;
+}
+
+// ---------------- JSON ----------------
+// writer แบบต่อท้าย string: ใส่ comma ให้เองตามระดับ (ไม่ escape อักขระพิเศษ: ชื่อทั้งหมดเป็น ASCII ธรรมดา)
+class GWJson {
+public:
+    GWJson& beginObject(const char* key = nullptr) { item(key); out += '{'; first.push_back(true); return *this; }
+    GWJson& endObject() { out += '}'; first.pop_back(); return *this; }
+    GWJson& beginArray(const char* key = nullptr) { item(key); out += '['; first.push_back(true); return *this; }
+    GWJson& endArray() { out += ']'; first.pop_back(); return *this; }
+
+    GWJson& value(const char* key, const std::string& s) { item(key); out += '"'; out += s; out += '"'; return *this; }
+    GWJson& value(const char* key, const char* s) { return value(key, std::string(s)); }
+    GWJson& value(const char* key, double v) {
+        char buf[32]; std::snprintf(buf, sizeof(buf), "%.6g", v);
+        item(key); out += buf; return *this;
+    }
+    GWJson& value(const char* key, long long v) { item(key); out += std::to_string(v); return *this; }
+    GWJson& value(const char* key, int v) { return value(key, (long long)v); }
+    GWJson& value(const char* key, const GWPercentiles& p) {
+        return beginObject(key).value("mean", p.mean).value("p50", p.p50).value("p90", p.p90)
+            .value("p99", p.p99).value("max", p.max).endObject();
+    }
+
+    const std::string& str() const { return out; }
+    bool save(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) return false;
+        bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size() && std::fputc('\n', f) != EOF;
+        return std::fclose(f) == 0 && ok;
+    }
+
+private:
+    void item(const char* key) {
+        if (!first.empty()) {
+            if (!first.back()) out += ',';
+            first.back() = false;
+        }
+        if (key) { out += '"'; out += key; out += "\":"; }
+    }
+    std::string out;
+    std::vector<bool> first;
+};
@@ -0,0 +1,207 @@
+// Grid Walk 3D — frame capture writer
+// ฝั่ง GL (FBO, ring ของ PBO + fence) อยู่ในไฟล์เกม: ที่นี่รับ pixel RGBA8 แบบ bottom-up ตามที่ glReadPixels ให้มา
+// แล้ว flip + encode + เขียนไฟล์บน thread ของตัวเอง; buffer หมุนเวียนใน pool ขนาดคงที่ (ไม่ allocate ต่อเฟรม)
+// png: frame_000000.png ต่อเฟรม (deflate แบบ stored = ไม่บีบอัด แต่ไม่ต้องพึ่ง zlib)
+// raw: capture.rgba ไฟล์เดียว เฟรม RGBA8 top-down ต่อกัน
+//      (ffmpeg -f rawvideo -pix_fmt rgba -s WxH -r 60 -i capture.rgba out.mp4)
+// ไม่มี GL ในไฟล์นี้
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum GWCaptureFormat { GW_CAPTURE_PNG, GW_CAPTURE_RAW };
+
+static const int GW_CAPTURE_POOL = 6;      // เฟรมที่รอ encode ได้พร้อมกัน (เต็ม = writer ตามไม่ทัน -> render รอ)
+
+// ---------------- PNG (stored deflate) ----------------
+static inline uint32_t gw_crc32(uint32_t crc, const unsigned char* p, size_t n) {
+    static const struct Table {
+        uint32_t v[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                v[i] = c;
+            }
+        }
+    } table;
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// RGBA8 bottom-up (แถว 0 = ล่างสุด) -> ไฟล์ PNG ทั้งไฟล์ใน out (ใช้ capacity เดิมของ out)
+static inline void gw_encodePng(const unsigned char* px, int w, int h, std::vector<unsigned char>& out) {
+    auto be32 = [&out](uint32_t v) {
+        unsigned char b[4] = { (unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v };
+        out.insert(out.end(), b, b + 4);
+    };
+    // chunk: จองที่ length + type ไว้ก่อน (ไม่ต้องเลื่อนข้อมูลทีหลัง), ปิดด้วยการเติม length แล้วต่อ crc
+    auto beginChunk = [&](const char* type) {
+        const size_t start = out.size();
+        be32(0);
+        out.insert(out.end(), type, type + 4);
+        return start;
+    };
+    auto endChunk = [&](size_t start) {
+        const uint32_t len = (uint32_t)(out.size() - start - 8);
+        for (int i = 0; i < 4; ++i) out[start + i] = (unsigned char)(len >> (24 - 8 * i));
+        be32(gw_crc32(0, out.data() + start + 4, len + 4));
+    };
+
+    static const unsigned char SIG[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.assign(SIG, SIG + 8);
+
+    size_t at = beginChunk("IHDR");
+    be32((uint32_t)w); be32((uint32_t)h);
+    const unsigned char ihdr[5] = { 8, 6, 0, 0, 0 };        // 8 bit, RGBA, deflate, filter 0, ไม่ interlace
+    out.insert(out.end(), ihdr, ihdr + 5);
+    endChunk(at);
+
+    // IDAT: zlib header + stored block ละไม่เกิน 65535 B + adler32; scanline = filter 0 + แถว (flip เป็น top-down)
+    const size_t row = (size_t)w * 4, raw = (row + 1) * (size_t)h;
+    out.reserve(out.size() + raw + raw / 65535 * 5 + 64);
+    at = beginChunk("IDAT");
+    out.push_back(0x78); out.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    size_t left = raw, inBlock = 0;
+    auto put = [&](const unsigned char* p, size_t n) {
+        while (n > 0) {
+            if (inBlock == 0) {
+                const size_t blk = std::min<size_t>(left, 65535);
+                out.push_back(left <= 65535 ? 1 : 0);
+                out.push_back((unsigned char)blk); out.push_back((unsigned char)(blk >> 8));
+                out.push_back((unsigned char)~blk); out.push_back((unsigned char)(~blk >> 8));
+                inBlock = blk;
+            }
+            const size_t k = std::min(n, inBlock);
+            out.insert(out.end(), p, p + k);
+            // adler32: mod ทีละ 5552 B (ค่ามากสุดที่ b ยังไม่ล้น 32 bit)
+            for (size_t i = 0; i < k;) {
+                const size_t end = std::min(k, i + 5552);
+                for (; i < end; ++i) { a += p[i]; b += a; }
+                a %= 65521u; b %= 65521u;
+            }
+            p += k; n -= k; inBlock -= k; left -= k;
+        }
+    };
+    const unsigned char filter = 0;
+    for (int y = h - 1; y >= 0; --y) {
+        put(&filter, 1);
+        put(px + (size_t)y * row, row);
+    }
+    be32(b << 16 | a);
+    endChunk(at);
+
+    endChunk(beginChunk("IEND"));
+}
+
+// ---------------- Writer thread ----------------
+// render thread: acquire() -> เติม pixel -> submit(); ลำดับเฟรม = ลำดับ submit
+// สถิติ (frames/bytes/encodeMs/failed) อ่านได้หลัง close()
+class GWCaptureWriter {
+public:
+    ~GWCaptureWriter() { close(); }
+
+    bool open(const std::string& dirPath, GWCaptureFormat fmt, int width, int height, std::string* err = nullptr) {
+        dir = dirPath; format = fmt; w = width; h = height;
+        if (format == GW_CAPTURE_RAW) {
+            raw = std::fopen((dir + "/capture.rgba").c_str(), "wb");
+            if (!raw) { if (err) *err = "cannot create " + dir + "/capture.rgba"; return false; }
+        }
+        pool.clear(); freeList.clear(); queue.clear();
+        for (int i = 0; i < GW_CAPTURE_POOL; ++i) {
+            pool.emplace_back(new std::vector<unsigned char>((size_t)w * h * 4));
+            freeList.push_back(pool.back().get());
+        }
+        queue.reserve(GW_CAPTURE_POOL);
+        quit = false;
+        worker = std::thread([this] { run(); });
+        return true;
+    }
+
+    // buffer ว่างขนาด w*h*4; pool หมด -> รอจน worker เขียนเสร็จไปหนึ่งเฟรม
+    std::vector<unsigned char>* acquire() {
+        std::unique_lock<std::mutex> lk(mu);
+        freed.wait(lk, [this] { return !freeList.empty(); });
+        std::vector<unsigned char>* buf = freeList.back();
+        freeList.pop_back();
+        return buf;
+    }
+    void submit(std::vector<unsigned char>* buf) {
+        { std::lock_guard<std::mutex> lk(mu); queue.push_back(buf); }
+        ready.notify_one();
+    }
+
+    // เขียนเฟรมที่ค้างให้หมดแล้วปิด thread
+    void close() {
+        if (!worker.joinable()) return;
+        { std::lock_guard<std::mutex> lk(mu); quit = true; }
+        ready.notify_one();
+        worker.join();
+        if (raw) { if (std::fclose(raw) != 0) ++failed; raw = nullptr; }
+    }
+
+    uint64_t frames = 0, bytes = 0, failed = 0;
+    double encodeMs = 0.0;      // encode + write รวมทุกเฟรม (บน worker)
+
+private:
+    void run() {
+        std::vector<unsigned char> png, flipped;
+        for (;;) {
+            std::vector<unsigned char>* buf;
+            {
+                std::unique_lock<std::mutex> lk(mu);
+                ready.wait(lk, [this] { return quit || !queue.empty(); });
+                if (queue.empty()) return;
+                buf = queue.front();
+                queue.erase(queue.begin());
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            bool ok;
+            if (format == GW_CAPTURE_PNG) {
+                gw_encodePng(buf->data(), w, h, png);
+                char name[32];
+                std::snprintf(name, sizeof(name), "/frame_%06llu.png", (unsigned long long)frames);
+                FILE* f = std::fopen((dir + name).c_str(), "wb");
+                ok = f && std::fwrite(png.data(), 1, png.size(), f) == png.size();
+                if (f && std::fclose(f) != 0) ok = false;
+                bytes += png.size();
+            }
+            else {
+                const size_t row = (size_t)w * 4;
+                flipped.resize(buf->size());
+                for (int y = 0; y < h; ++y)
+                    std::copy_n(buf->data() + (size_t)(h - 1 - y) * row, row, flipped.data() + (size_t)y * row);
+                ok = std::fwrite(flipped.data(), 1, flipped.size(), raw) == flipped.size();
+                bytes += flipped.size();
+            }
+            encodeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            ++frames;
+            if (!ok) ++failed;
+            { std::lock_guard<std::mutex> lk(mu); freeList.push_back(buf); }
+            freed.notify_one();
+        }
+    }
+
+    std::string dir;
+    GWCaptureFormat format = GW_CAPTURE_PNG;
+    int w = 0, h = 0;
+    FILE* raw = nullptr;
+    std::vector<std::unique_ptr<std::vector<unsigned char>>> pool;
+    std::vector<std::vector<unsigned char>*> freeList, queue;
+    std::mutex mu;
+    std::condition_variable ready, freed;
+    bool quit = false;
+    std::thread worker;
+};
@@ -0,0 +1,233 @@
+// Grid Walk 3D — batched environment (หลายเกมอิสระใน process เดียว)
+// สำหรับ agent อัตโนมัติ / playtest จำนวนมาก: step ทุกเกมด้วย call เดียว (action 1 byte ต่อเกม)
+// แล้วอ่าน observation + event ของทุกเกมจาก array ต่อกัน (เกม i อยู่ที่ offset i * stride)
+// แต่ละเกมคือ GWWorld ของตัวเอง (state ทั้งหมดอยู่ใน world ไม่มี global) รันบน thread เดียว;
+// เกมต่างๆ กระจายไปตาม core ด้วย GWJobSystem -> ผลไม่ขึ้นกับจำนวน thread
+// ผนังของแผนที่แชร์กันทุกเกม (GWGrid::mapped ชี้ buffer เดียว) จึงไม่ copy grid N ชุด
+// step ไม่ allocate: pool/scratch ของ world และ buffer ของ observation จองไว้ตอนสร้าง
+// ไม่มี GL ในไฟล์นี้
+
+#pragma once
+
+#include "gw_world.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// action ต่อเกม: bit 0..2 = ทิศ (0 = ไม่กด, 1..4 = GW_DIRS[k - 1]), bit 3 = ยิง
+enum : uint8_t {
+    GW_ACT_NONE = 0, GW_ACT_RIGHT = 1, GW_ACT_LEFT = 2, GW_ACT_DOWN = 3, GW_ACT_UP = 4,
+    GW_ACT_FIRE = 8
+};
+
+static inline GWInputState gw_envInput(uint8_t a) {
+    GWInputState in;
+    const uint8_t d = a & 7;
+    if (d >= 1 && d <= 4) in.dir = GW_DIRS[d - 1];
+    in.fire = (a & GW_ACT_FIRE) != 0;
+    return in;
+}
+static inline uint8_t gw_envAction(const GWInputState& in) {
+    uint8_t a = GW_ACT_NONE;
+    for (uint8_t k = 0; k < 4; ++k)
+        if (in.dir == GW_DIRS[k]) a = k + 1;
+    return in.fire ? (uint8_t)(a | GW_ACT_FIRE) : a;
+}
+
+// ค่าใน tile window (ซ้อนกันได้: ผี > กระสุน > ปืน > พื้น/ผนัง)
+enum : uint8_t { GW_OBS_FLOOR = 0, GW_OBS_WALL = 1, GW_OBS_GUN = 2, GW_OBS_BULLET = 3, GW_OBS_GHOST = 4 };
+
+// state ต่อเกม (float): ผู้เล่น x, y, ทิศ x, y, มีปืน, cooldown, จำนวนผี, กระสุนที่ยังบิน
+// ตามด้วย (dx, dy) ของผีที่ใกล้สุด K ตัวเรียงจากใกล้ไปไกล (มีไม่ครบ = 0)
+static const int GW_ENV_STATE_FIXED = 8;
+static const int GW_ENV_MAX_NEAREST = 32;
+
+// สิ่งที่เกิดใน step ล่าสุดของแต่ละเกม
+struct GWEnvEvent {
+    uint8_t gunPicked = 0;
+    uint8_t ghostsShot = 0;     // ตัน 255
+    uint8_t caught = 0;         // โดนจับ: world reset แล้วใน step เดียวกัน
+    uint8_t truncated = 0;      // ครบ maxEpisodeTicks: reset แล้ว
+};
+
+struct GWEnvConfig {
+    int viewRadius = 7;                 // tile window (2r + 1)^2 รอบผู้เล่น; 0 = ไม่มี
+    int nearestGhosts = 8;              // K (<= GW_ENV_MAX_NEAREST)
+    uint32_t maxEpisodeTicks = 0;       // 0 = เล่นจนโดนจับ
+    size_t maxGhosts = 0, maxBullets = 0;   // pool ต่อเกมเพิ่มจากของแผนที่ (ดู GWWorld::reserve)
+};
+
+// grid ที่อ่านผนังและ key index จาก master (read-only) + copy ตาราง spawn/key; master อยู่จนกว่า view ตัวสุดท้ายหายไป
+static inline GWGrid gw_sharedGrid(const std::shared_ptr<const GWGrid>& master) {
+    GWGrid g;
+    g.w = master->w; g.h = master->h;
+    g.cw = master->cw; g.ch = master->ch;
+    g.mapped = std::shared_ptr<const uint64_t>(master, master->words());
+    g.contentHash = master->contentHash;
+    g.keys = master->keys;
+    g.keyIndex = master->keyIndex;
+    g.playerSpawns = master->playerSpawns;
+    g.ghostSpawns = master->ghostSpawns;
+    return g;
+}
+
+class GWEnvBatch {
+public:
+    GWEnvBatch(const GWGrid& map, size_t count, const GWEnvConfig& config = GWEnvConfig{}, GWJobSystem* jobSystem = nullptr)
+        : cfg(config), jobs(jobSystem) {
+        cfg.viewRadius = std::max(cfg.viewRadius, 0);
+        cfg.nearestGhosts = std::min(std::max(cfg.nearestGhosts, 0), GW_ENV_MAX_NEAREST);
+        view = cfg.viewRadius > 0 ? 2 * cfg.viewRadius + 1 : 0;
+        tileStride = (size_t)view * view;
+        stateStride = (size_t)GW_ENV_STATE_FIXED + 2 * (size_t)cfg.nearestGhosts;
+
+        GWGrid m = map;
+        m.indexKeys();          // ครั้งเดียว: ทุก world แชร์ index เดียวกัน (load ไม่สร้างซ้ำ)
+        master = std::make_shared<const GWGrid>(std::move(m));
+        worlds.resize(count);
+        for (GWWorld& w : worlds) {
+            w.load(gw_sharedGrid(master));
+            w.reserve(std::max<size_t>(map.ghostSpawns.size(), 1) + cfg.maxGhosts, GW_PLAYER_BULLETS + cfg.maxBullets);
+        }
+        tileBuf.assign(count * tileStride, GW_OBS_FLOOR);
+        stateBuf.assign(count * stateStride, 0.0f);
+        eventBuf.assign(count, GWEnvEvent{});
+        episode.assign(count, 0);
+        for (size_t i = 0; i < count; ++i) observe(i);
+    }
+
+    size_t size() const { return worlds.size(); }
+    int    viewSize() const { return view; }                    // ด้านของ tile window
+    size_t tilesPerEnv() const { return tileStride; }
+    size_t statePerEnv() const { return stateStride; }
+
+    // actions[size()]: เดินทุกเกม 1 tick แล้วเขียน observation/event ใหม่
+    void step(const uint8_t* actions) {
+        auto run = [this, actions](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) stepOne(i, actions[i]);
+        };
+        const size_t n = worlds.size();
+        if (jobs && jobs->threadCount() > 1) {
+            // ~8 ก้อนต่อ thread: พอให้ขโมยงานเกลี่ยเกมที่ช้ากว่ากันได้ โดยไม่เสีย overhead ต่อก้อนมาก
+            const size_t grain = std::max<size_t>(16, n / ((size_t)jobs->threadCount() * 8));
+            jobs->parallelFor(n, grain, run);
+        }
+        else run(0, n);
+        ticks += n;
+    }
+
+    void reset(size_t i) {
+        worlds[i].reset();
+        episode[i] = 0;
+        eventBuf[i] = GWEnvEvent{};
+        observe(i);
+    }
+    void resetAll() { for (size_t i = 0; i < worlds.size(); ++i) reset(i); }
+
+    // ต่อกันทั้ง batch: เกม i อยู่ที่ tiles() + i * tilesPerEnv(), state() + i * statePerEnv(), events()[i]
+    const uint8_t*    tiles() const { return tileBuf.data(); }
+    const float*      state() const { return stateBuf.data(); }
+    const GWEnvEvent* events() const { return eventBuf.data(); }
+    const uint32_t*   episodeTicks() const { return episode.data(); }
+
+    const GWWorld& world(size_t i) const { return worlds[i]; }
+    uint64_t totalTicks() const { return ticks; }               // รวมทุกเกม
+
+private:
+    void stepOne(size_t i, uint8_t action) {
+        GWWorld& w = worlds[i];
+        w.step(GW_SIM_DT, gw_envInput(action));
+        GWEnvEvent& ev = eventBuf[i];
+        ev.gunPicked = w.events.gunPicked;
+        ev.ghostsShot = (uint8_t)std::min(w.events.ghostsShot, 255);
+        ev.caught = w.events.caught;
+        ev.truncated = 0;
+        episode[i] = w.events.caught ? 0 : episode[i] + 1;
+        if (cfg.maxEpisodeTicks > 0 && episode[i] >= cfg.maxEpisodeTicks) {
+            w.reset();
+            episode[i] = 0;
+            ev.truncated = 1;
+        }
+        observe(i);
+    }
+
+    void observe(size_t i) {
+        const GWWorld& w = worlds[i];
+        const glm::vec2 p = w.player.pos;
+
+        float* s = stateBuf.data() + i * stateStride;
+        s[0] = p.x; s[1] = p.y;
+        s[2] = (float)w.player.ctrl.dir.x; s[3] = (float)w.player.ctrl.dir.y;
+        s[4] = w.hasGun ? 1.0f : 0.0f;
+        s[5] = std::max(w.fireCooldown, 0.0f);
+        s[6] = (float)w.ghosts.size();
+        s[7] = (float)w.bullets.live;
+
+        // K ตัวที่ใกล้สุด: insertion ลง array ขนาดคงที่บน stack (ผีต่อเกมมีไม่มาก)
+        const int K = cfg.nearestGhosts;
+        if (K > 0) {
+            float bestD[GW_ENV_MAX_NEAREST];
+            uint32_t bestI[GW_ENV_MAX_NEAREST];
+            int found = 0;
+            const GWGhosts& g = w.ghosts;
+            for (uint32_t gi = 0; gi < (uint32_t)g.size(); ++gi) {
+                const float dx = g.x[gi] - p.x, dy = g.y[gi] - p.y, d = dx * dx + dy * dy;
+                if (found == K && d >= bestD[K - 1]) continue;
+                int k = found < K ? found++ : K - 1;
+                for (; k > 0 && bestD[k - 1] > d; --k) { bestD[k] = bestD[k - 1]; bestI[k] = bestI[k - 1]; }
+                bestD[k] = d; bestI[k] = gi;
+            }
+            float* near = s + GW_ENV_STATE_FIXED;
+            for (int k = 0; k < K; ++k) {
+                near[2 * k] = k < found ? g.x[bestI[k]] - p.x : 0.0f;
+                near[2 * k + 1] = k < found ? g.y[bestI[k]] - p.y : 0.0f;
+            }
+        }
+
+        if (view == 0) return;
+        uint8_t* t = tileBuf.data() + i * tileStride;
+        const int r = cfg.viewRadius;
+        const glm::ivec2 c = gw_tileOf(p);
+        for (int y = 0; y < view; ++y) {
+            // view > 64 -> ทีละช่วง 64 tile
+            for (int x0 = 0; x0 < view; x0 += 64) {
+                const int n = std::min(64, view - x0);
+                const uint64_t bits = w.grid.rowBits(c.x - r + x0, c.y - r + y, n);
+                for (int k = 0; k < n; ++k) t[y * view + x0 + k] = (uint8_t)((bits >> k) & 1u);   // GW_OBS_WALL = 1
+            }
+        }
+        auto mark = [&](const glm::vec2& e, uint8_t v) {
+            const glm::ivec2 d = gw_tileOf(e) - c + glm::ivec2(r);
+            if ((unsigned)d.x < (unsigned)view && (unsigned)d.y < (unsigned)view) t[d.y * view + d.x] = v;
+        };
+        // ปืน: จาก key index ของแผนที่ (ไม่ไล่ตารางปืนทั้งแผนที่); แถวของหน้าต่างมี key น้อย -> กรอง x ตรงๆ
+        // ไม่งั้นค้นทีละแถว
+        auto gun = [&](uint32_t k) {
+            const glm::ivec2 d = w.grid.keys[k] - c + glm::ivec2(r);
+            if ((unsigned)d.x < (unsigned)view && !w.keyTaken[k]) t[d.y * view + d.x] = GW_OBS_GUN;
+        };
+        const GWKeySpan rows = w.grid.keysInRows(c.y - r, c.y + r + 1);
+        if (rows.last - rows.first <= view) { for (uint32_t k : rows) gun(k); }
+        else {
+            for (int y = 0; y < view; ++y)
+                for (uint32_t k : w.grid.keysIn(c.y - r + y, c.x - r, c.x + r + 1)) gun(k);
+        }
+        for (size_t b = 0; b < w.bullets.slots(); ++b)
+            if (w.bullets.alive[b]) mark(w.bullets.pos(b), GW_OBS_BULLET);
+        for (size_t gi = 0; gi < w.ghosts.size(); ++gi) mark(w.ghosts.pos(gi), GW_OBS_GHOST);
+    }
+
+    GWEnvConfig cfg;
+    GWJobSystem* jobs;                  // ไม่ได้เป็นเจ้าของ; nullptr = ทุกเกมบน thread ที่เรียก
+    std::shared_ptr<const GWGrid> master;
+    std::vector<GWWorld> worlds;
+    int view = 0;
+    size_t tileStride = 0, stateStride = 0;
+    std::vector<uint8_t> tileBuf;
+    std::vector<float> stateBuf;
+    std::vector<GWEnvEvent> eventBuf;
+    std::vector<uint32_t> episode;
+    uint64_t ticks = 0;
+};
@@ -0,0 +1,239 @@
+// Grid Walk 3D — packed tile grid
+// ผนังเก็บเป็น bitset 1 bit ต่อ tile แบ่งเป็น chunk 64x64 tile (64 word ต่อ chunk, chunk เรียงแบบ row-major)
+// layout เดียวกับไฟล์ .gwl (gw_level.h) จึงชี้ตรงเข้าไฟล์ที่ mmap ไว้ได้โดยไม่ต้อง copy
+// ขอบรอบแผนที่ถูก pad เป็นผนัง PAD ช่อง: wall(x, y) ไม่ต้องเช็ค bounds สำหรับ -PAD <= x < w + PAD
+// Special cells ('K', 'P', 'G') are kept as small lists; text (GW_MAP style) is only the input format.
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline int gw_popcount64(uint64_t v) {
+#if defined(_MSC_VER)
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+// ---------------- Key index ----------------
+// grid.keys เรียงตาม tile (แถว y ก่อน x): key บน tile หนึ่ง / ในช่วงของแถวหนึ่งหาได้ด้วย binary search แทนไล่ทั้งตาราง
+// สร้างครั้งเดียวต่อแผนที่แล้วแชร์ผ่าน shared_ptr: copy ของ grid (เช่นทุก world ใน GWEnvBatch) ใช้ก้อนเดียวกัน
+struct GWKeyIndex {
+    std::vector<uint64_t> tile;         // tileOf(x, y) เรียงจากน้อยไปมาก
+    std::vector<uint32_t> index;        // index ใน GWGrid::keys ของ tile[i] (tile เดียวกัน: index น้อยก่อน)
+
+    static uint64_t tileOf(int x, int y) { return (uint64_t)(uint32_t)y << 32 | (uint32_t)x; }
+
+    explicit GWKeyIndex(const std::vector<glm::ivec2>& keys) {
+        index.resize(keys.size());
+        for (uint32_t i = 0; i < (uint32_t)keys.size(); ++i) index[i] = i;
+        std::sort(index.begin(), index.end(), [&keys](uint32_t a, uint32_t b) {
+            const uint64_t ta = tileOf(keys[a].x, keys[a].y), tb = tileOf(keys[b].x, keys[b].y);
+            return ta != tb ? ta < tb : a < b;
+        });
+        tile.resize(keys.size());
+        for (size_t i = 0; i < index.size(); ++i) tile[i] = tileOf(keys[index[i]].x, keys[index[i]].y);
+    }
+};
+
+// ช่วงของ index (ใช้กับ range-for)
+struct GWKeySpan {
+    const uint32_t* first = nullptr;
+    const uint32_t* last = nullptr;
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+};
+
+struct GWGrid {
+    enum { PAD = 1, CHUNK = 64 };         // CHUNK = tile ต่อด้านของ chunk (1 word ต่อแถว)
+
+    int w = 0, h = 0;
+    int cw = 0, ch = 0;                  // จำนวน chunk ของพื้นที่ที่ pad แล้ว
+    std::vector<uint64_t> bits;          // cw * ch chunks * CHUNK words, bit = 1 -> wall
+    std::shared_ptr<const uint64_t> mapped;   // != nullptr -> อ่านจากไฟล์ที่ map ไว้แทน bits (read-only)
+    uint64_t contentHash = 0;            // != 0 และ mapped -> hash() คืนค่านี้ (เขียนไว้ใน header ของ .gwl)
+
+    std::vector<glm::ivec2> keys;          // 'K'
+    std::vector<glm::ivec2> playerSpawns;  // 'P'
+    std::vector<glm::ivec2> ghostSpawns;   // 'G'
+    std::shared_ptr<const GWKeyIndex> keyIndex;   // ดู indexKeys() (GWWorld::load เรียกให้)
+
+    // สร้าง keyIndex ถ้ายังไม่มีหรือไม่ตรงกับ keys (เรียกใหม่หลังแก้ keys)
+    void indexKeys() {
+        if (!keyIndex || keyIndex->index.size() != keys.size()) keyIndex = std::make_shared<const GWKeyIndex>(keys);
+    }
+    // index ใน keys ของ key ที่อยู่บนแถว y และ x0 <= x < x1 (ยังไม่ indexKeys = ว่าง)
+    GWKeySpan keysIn(int y, int x0, int x1) const {
+        return y < 0 || x1 <= std::max(x0, 0) ? GWKeySpan{} : keySpan(GWKeyIndex::tileOf(std::max(x0, 0), y), GWKeyIndex::tileOf(x1, y));
+    }
+    // key ทุกตัวบนแถว y0 <= y < y1 (ทุก x)
+    GWKeySpan keysInRows(int y0, int y1) const {
+        y0 = std::max(y0, 0);
+        return y1 <= y0 ? GWKeySpan{} : keySpan(GWKeyIndex::tileOf(0, y0), GWKeyIndex::tileOf(0, y1));
+    }
+    GWKeySpan keySpan(uint64_t lo, uint64_t hi) const {
+        GWKeySpan r;
+        if (!keyIndex) return r;
+        const GWKeyIndex& k = *keyIndex;
+        const size_t a = (size_t)(std::lower_bound(k.tile.begin(), k.tile.end(), lo) - k.tile.begin());
+        const size_t b = (size_t)(std::lower_bound(k.tile.begin() + a, k.tile.end(), hi) - k.tile.begin());
+        r.first = k.index.data() + a;
+        r.last = k.index.data() + b;
+        return r;
+    }
+
+    static GWGrid fromText(const std::vector<std::string>& text);
+
+    static int chunksFor(int tiles) { return (tiles + 2 * PAD + CHUNK - 1) / CHUNK; }
+
+    void resize(int width, int height) {
+        w = width; h = height;
+        cw = chunksFor(w); ch = chunksFor(h);
+        mapped.reset();
+        contentHash = 0;
+        bits.assign((size_t)cw * ch * CHUNK, ~0ull);   // เริ่มจากผนังทั้งหมด (รวม pad)
+    }
+
+    const uint64_t* words() const { return mapped ? mapped.get() : bits.data(); }
+
+    // Hot path: no bounds check, valid for -PAD <= x < w + PAD and -PAD <= y < h + PAD
+    bool wall(int x, int y) const {
+        unsigned px = (unsigned)(x + PAD), py = (unsigned)(y + PAD);
+        return (words()[((size_t)(py >> 6) * cw + (px >> 6)) * CHUNK + (py & 63)] >> (px & 63)) & 1u;
+    }
+    // Any coordinates; outside the map counts as wall
+    bool wallChecked(int x, int y) const {
+        if (x < -PAD || x >= w + PAD || y < -PAD || y >= h + PAD) return true;
+        return wall(x, y);
+    }
+    bool inside(int x, int y) const { return x >= 0 && x < w && y >= 0 && y < h; }
+
+    // ผนังของ n tile (n <= 64) บนแถว y เริ่มที่ x0: bit k = tile (x0 + k, y); นอก pad = ผนัง (เหมือน wallChecked)
+    // อ่านทีละ word ของ chunk (อย่างมาก 2 word) แทนการเรียก wallChecked ทีละ tile
+    uint64_t rowBits(int x0, int y, int n) const {
+        const uint64_t keep = n >= 64 ? ~0ull : (1ull << n) - 1;
+        if (y < -PAD || y >= h + PAD) return keep;
+        const int py = y + PAD, lo = x0 + PAD, hi = lo + n;     // padded column [lo, hi)
+        const int wpad = w + 2 * PAD;
+        auto word = [&](int base) -> uint64_t {                 // 64 bit เริ่มที่ padded column base (พหุคูณของ 64)
+            return base < 0 || base >= wpad ? ~0ull : chunk(base >> 6, py >> 6)[py & 63];
+        };
+        const int base = lo & ~63, sh = lo - base;              // & ~63 = ปัดลงแม้ lo ติดลบ
+        uint64_t v = word(base) >> sh;
+        if (sh > 0 && sh + n > 64) v |= word(base + 64) << (64 - sh);
+        if (lo < 0) v |= lo <= -64 ? ~0ull : (1ull << -lo) - 1;                         // ซ้ายของ pad
+        if (hi > wpad) {                                                                // ขวาของ pad (wpad - lo < n <= 64)
+            const int k = wpad - lo;
+            v = k <= 0 ? ~0ull : v | ~0ull << k;
+        }
+        return v & keep;
+    }
+
+    void setWall(int x, int y, bool v) {
+        unsigned px = (unsigned)(x + PAD), py = (unsigned)(y + PAD);
+        uint64_t& word = bits[((size_t)(py >> 6) * cw + (px >> 6)) * CHUNK + (py & 63)];
+        uint64_t m = 1ull << (px & 63);
+        word = v ? (word | m) : (word & ~m);
+    }
+
+    // Chunk access for bulk queries: word r of chunk (cx, cy) = padded row cy*CHUNK + r,
+    // bit b = padded column cx*CHUNK + b
+    const uint64_t* chunk(int cx, int cy) const { return words() + ((size_t)cy * cw + cx) * CHUNK; }
+    size_t chunkIndexOf(int x, int y) const {
+        return (size_t)((unsigned)(y + PAD) >> 6) * cw + ((unsigned)(x + PAD) >> 6);
+    }
+
+    // จำนวนผนังภายในแผนที่ (ไม่นับ pad) ด้วย popcount ทีละ word
+    size_t countWalls() const {
+        size_t n = 0;
+        for (int cy = 0; cy < ch; ++cy) {
+            for (int cx = 0; cx < cw; ++cx) {
+                const uint64_t* c = chunk(cx, cy);
+                int lo = cx * CHUNK;                              // padded column ของ bit 0
+                uint64_t mask = ~0ull;
+                if (lo < PAD) mask &= ~0ull << (PAD - lo);        // ตัด pad ด้านซ้าย
+                if (lo + 64 > w + PAD) mask &= (w + PAD - lo) >= 64 ? ~0ull : ((1ull << (w + PAD - lo)) - 1);
+                for (int r = 0; r < CHUNK; ++r) {
+                    int py = cy * CHUNK + r;
+                    if (py < PAD || py >= h + PAD) continue;      // แถว pad / เลยแผนที่
+                    n += (size_t)gw_popcount64(c[r] & mask);
+                }
+            }
+        }
+        return n;
+    }
+
+    size_t bytes() const { return (size_t)cw * ch * CHUNK * sizeof(uint64_t); }
+
+    // ตัวระบุแผนที่ (text กับ .gwl ของแผนที่เดียวกันได้ค่าเดียวกัน). grid จาก .gwl คืนค่าใน header
+    // ไม่ต้องอ่านผนังทุก word (จะดึงทั้งไฟล์ที่ map ไว้เข้าหน่วยความจำ)
+    uint64_t hash() const { return mapped && contentHash ? contentHash : scanHash(); }
+    // FNV-1a ของขนาด + ผนังทุก word + ตาราง spawn/key
+    uint64_t scanHash() const {
+        uint64_t hv = 14695981039346656037ull;
+        auto mix = [&hv](uint64_t v) { hv = (hv ^ v) * 1099511628211ull; };
+        mix((uint64_t)(uint32_t)w << 32 | (uint32_t)h);
+        const uint64_t* wd = words();
+        for (size_t i = 0, n = (size_t)cw * ch * CHUNK; i < n; ++i) mix(wd[i]);
+        for (const auto* list : { &playerSpawns, &ghostSpawns, &keys }) {
+            mix(list->size());
+            for (const glm::ivec2& t : *list) mix((uint64_t)(uint32_t)t.x << 32 | (uint32_t)t.y);
+        }
+        return hv;
+    }
+
+    // Grid DDA (Amanatides & Woo): เดินทีละ tile ตามเส้น a -> b, ทุก tile ที่เส้นผ่าน (ไม่ข้ามมุม)
+    // เจอผนัง -> true และ t = สัดส่วน (0..1) ของเส้นตอนเข้า tile นั้น; a อยู่ในผนังเอง -> t = 0
+    bool raycast(const glm::vec2& a, const glm::vec2& b, float& t) const {
+        int x = (int)std::floor(a.x), y = (int)std::floor(a.y);
+        t = 0.0f;
+        if (wallChecked(x, y)) return true;
+        const glm::vec2 d = b - a;
+        const float inf = std::numeric_limits<float>::infinity();
+        const int sx = d.x > 0.0f ? 1 : -1, sy = d.y > 0.0f ? 1 : -1;
+        const float stepX = d.x != 0.0f ? std::fabs(1.0f / d.x) : inf;     // t ต่อ 1 tile ตามแกน
+        const float stepY = d.y != 0.0f ? std::fabs(1.0f / d.y) : inf;
+        float nextX = d.x != 0.0f ? (sx > 0 ? (float)(x + 1) - a.x : a.x - (float)x) * stepX : inf;
+        float nextY = d.y != 0.0f ? (sy > 0 ? (float)(y + 1) - a.y : a.y - (float)y) * stepY : inf;
+        // จำนวนเส้นแบ่ง tile ที่ข้าม = ระยะ Manhattan ระหว่าง tile ต้น/ปลาย
+        for (int n = std::abs((int)std::floor(b.x) - x) + std::abs((int)std::floor(b.y) - y); n > 0; --n) {
+            if (nextX < nextY) { t = nextX; x += sx; nextX += stepX; }
+            else { t = nextY; y += sy; nextY += stepY; }
+            if (wallChecked(x, y)) { t = std::min(t, 1.0f); return true; }
+        }
+        return false;
+    }
+};
+
+// อ่านแผนที่แบบข้อความ: แถวสั้นเติม '#', แถวยาวตัดทิ้ง (เหมือน gw_fixMapWidth เดิม)
+inline GWGrid GWGrid::fromText(const std::vector<std::string>& text) {
+    GWGrid g;
+    int height = (int)text.size();
+    int width = height ? (int)text[0].size() : 0;
+    g.resize(width, height);
+    for (int y = 0; y < height; ++y) {
+        const std::string& r = text[y];
+        for (int x = 0; x < width; ++x) {
+            char c = x < (int)r.size() ? r[x] : '#';
+            if (c == '#') continue;
+            g.setWall(x, y, false);
+            if (c == 'K') g.keys.push_back({ x, y });
+            else if (c == 'P') g.playerSpawns.push_back({ x, y });
+            else if (c == 'G') g.ghostSpawns.push_back({ x, y });
+        }
+    }
+    return g;
+}
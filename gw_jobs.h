@@ -0,0 +1,133 @@
+// Grid Walk 3D — small work-stealing job system
+// แต่ละ thread มี deque ของตัวเอง: pop งานจากท้ายของตัวเอง, ถ้าหมดก็ขโมยจากหัวของ thread อื่น
+// deque เป็น ring ขนาดยกกำลังสองที่จองไว้ตั้งแต่สร้าง (std::deque allocate/free block ทุกรอบ) -> parallelFor ไม่ allocate
+// ใช้ผ่าน parallelFor เท่านั้น (thread ที่เรียกช่วยทำงานจนครบแล้วค่อย return); ไม่รองรับ parallelFor ซ้อนกัน
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GWJobSystem {
+public:
+    // threads = 0 -> เท่าจำนวน core, 1 -> ไม่สร้าง worker (ทำทุกอย่างบน thread ที่เรียก)
+    explicit GWJobSystem(int threads = 0) {
+        if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+        queues = std::vector<Queue>(threads);
+        for (int i = 1; i < threads; ++i) workers.emplace_back([this, i] { workerLoop(i); });
+    }
+    ~GWJobSystem() {
+        {
+            std::lock_guard<std::mutex> lk(sleepMutex);
+            stop = true;
+        }
+        sleepCv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+    GWJobSystem(const GWJobSystem&) = delete;
+    GWJobSystem& operator=(const GWJobSystem&) = delete;
+
+    int threadCount() const { return (int)queues.size(); }
+
+    // fn(begin, end) กับทุกช่วงขนาด grain ของ [0, n); ช่วงไม่ทับกันจึงเขียน slot ของตัวเองได้โดยไม่ lock
+    template<class F>
+    void parallelFor(size_t n, size_t grain, const F& fn) {
+        if (n == 0) return;
+        if (grain == 0) grain = 1;
+        if (queues.size() == 1 || n <= grain) { fn((size_t)0, n); return; }
+
+        const size_t chunks = (n + grain - 1) / grain;
+        std::atomic<size_t> pending{ chunks };
+        {
+            std::lock_guard<std::mutex> lk(sleepMutex);
+            queued += chunks;
+        }
+        for (size_t c = 0; c < chunks; ++c) {
+            Job j{ &GWJobSystem::invoke<F>, &fn, c * grain, std::min(n, (c + 1) * grain), &pending };
+            Queue& q = queues[c % queues.size()];
+            std::lock_guard<std::mutex> lk(q.m);
+            q.pushBack(j);
+        }
+        sleepCv.notify_all();
+
+        // thread ที่เรียก = worker 0: ช่วยทำจนงานของรอบนี้หมด
+        Job j;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (take(0, j)) run(j);
+            else std::this_thread::yield();
+        }
+    }
+
+private:
+    struct Job {
+        void (*call)(const void*, size_t, size_t) = nullptr;
+        const void* fn = nullptr;
+        size_t begin = 0, end = 0;
+        std::atomic<size_t>* pending = nullptr;
+    };
+    // head/tail นับขึ้นเรื่อยๆ, slot = index & (size - 1); เต็ม -> ขยายเท่าตัว (เกิดเฉพาะ parallelFor ที่มีก้อนมากกว่าที่เคย)
+    struct Queue {
+        std::mutex m;
+        std::vector<Job> ring = std::vector<Job>(64);
+        size_t head = 0, tail = 0;
+
+        bool empty() const { return head == tail; }
+        void pushBack(const Job& j) {
+            if (tail - head == ring.size()) grow();
+            ring[tail++ & (ring.size() - 1)] = j;
+        }
+        Job popBack() { return ring[--tail & (ring.size() - 1)]; }
+        Job popFront() { return ring[head++ & (ring.size() - 1)]; }
+        void grow() {
+            std::vector<Job> bigger(ring.size() * 2);
+            for (size_t i = head; i < tail; ++i) bigger[i - head] = ring[i & (ring.size() - 1)];
+            tail -= head; head = 0;
+            ring.swap(bigger);
+        }
+    };
+
+    template<class F>
+    static void invoke(const void* fn, size_t b, size_t e) { (*static_cast<const F*>(fn))(b, e); }
+
+    static void run(const Job& j) {
+        j.call(j.fn, j.begin, j.end);
+        j.pending->fetch_sub(1, std::memory_order_release);
+    }
+
+    // ของตัวเองก่อน (ท้าย deque = งานที่เพิ่งใส่, ยังอุ่นใน cache) แล้วค่อยขโมยหัว deque ของคนอื่น
+    bool take(int self, Job& out) {
+        const int n = (int)queues.size();
+        for (int k = 0; k < n; ++k) {
+            Queue& q = queues[(self + k) % n];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (q.empty()) continue;
+            out = k == 0 ? q.popBack() : q.popFront();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(int self) {
+        Job j;
+        for (;;) {
+            if (take(self, j)) { run(j); continue; }
+            std::unique_lock<std::mutex> lk(sleepMutex);
+            sleepCv.wait(lk, [this] { return stop || queued.load(std::memory_order_relaxed) > 0; });
+            if (stop) return;
+        }
+    }
+
+    std::vector<Queue> queues;              // [0] = thread ที่เรียก parallelFor
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{ 0 };        // งานที่ยังไม่มีใครหยิบ (ใช้ตัดสินใจนอน)
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    bool stop = false;
+};
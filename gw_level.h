@@ -0,0 +1,227 @@
+// Grid Walk 3D — binary level file (.gwl)
+// header + ตาราง spawn/key + ผนังแบบ chunk 64x64 tile (layout เดียวกับ GWGrid) ต่อกันเป็นก้อนเดียว
+// เปิดด้วย mmap: โหลดแค่ header/ตาราง, หน้าของ chunk ถูกอ่านจากดิสก์ตอนแตะครั้งแรกเท่านั้น
+// GWChunkResidency ปล่อยหน้าของ chunk ที่ไกลผู้เล่นคืน OS (อ่านใหม่จากไฟล์ได้เสมอเพราะ map แบบ read-only)
+//
+// File layout (little-endian):
+//   GWLevelHeader
+//   int32 x,y pairs: playerSpawns, ghostSpawns, keys       @ tableOffset
+//   chunksX * chunksY chunks of 64 uint64 rows             @ chunkOffset (aligned to GW_LEVEL_ALIGN)
+
+#pragma once
+
+#include "gw_grid.h"
+#include "gw_mmap.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+static const uint32_t GW_LEVEL_MAGIC = 0x4C575747u;    // "GWWL"
+static const uint32_t GW_LEVEL_VERSION = 2;            // 2: + contentHash
+static const uint64_t GW_LEVEL_ALIGN = 4096;           // chunk data เริ่มที่ขอบ page
+static const int GW_LEVEL_RESIDENT_RADIUS = 3;         // chunk รอบผู้เล่นที่เก็บไว้ (ครอบหน้าต่าง flow field ของแผนที่ใหญ่)
+
+struct GWLevelHeader {
+    uint32_t magic = GW_LEVEL_MAGIC;
+    uint32_t version = GW_LEVEL_VERSION;
+    int32_t  width = 0, height = 0;
+    uint32_t chunkTiles = GWGrid::CHUNK;
+    uint32_t pad = GWGrid::PAD;
+    uint32_t chunksX = 0, chunksY = 0;
+    uint32_t playerCount = 0, ghostCount = 0, keyCount = 0;
+    uint32_t reserved = 0;
+    uint64_t tableOffset = 0;
+    uint64_t chunkOffset = 0;
+    uint64_t fileBytes = 0;
+    uint64_t contentHash = 0;       // GWGrid::hash() ตอนเขียน: replay เช็คแผนที่ได้โดยไม่อ่าน chunk
+};
+static_assert(sizeof(GWLevelHeader) == 80, "GWLevelHeader is part of the file format");
+
+// ---------------- Writer ----------------
+static inline bool gw_writeLevelFile(const GWGrid& g, const std::string& path, std::string* err = nullptr) {
+    GWLevelHeader hd;
+    hd.width = g.w; hd.height = g.h;
+    hd.chunksX = (uint32_t)g.cw; hd.chunksY = (uint32_t)g.ch;
+    hd.playerCount = (uint32_t)g.playerSpawns.size();
+    hd.ghostCount = (uint32_t)g.ghostSpawns.size();
+    hd.keyCount = (uint32_t)g.keys.size();
+    hd.tableOffset = sizeof(GWLevelHeader);
+    uint64_t tableBytes = (uint64_t)(hd.playerCount + hd.ghostCount + hd.keyCount) * 2 * sizeof(int32_t);
+    hd.chunkOffset = (hd.tableOffset + tableBytes + GW_LEVEL_ALIGN - 1) / GW_LEVEL_ALIGN * GW_LEVEL_ALIGN;
+    hd.fileBytes = hd.chunkOffset + g.bytes();
+    hd.contentHash = g.hash();
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) { if (err) *err = "cannot create " + path; return false; }
+    f.write((const char*)&hd, sizeof(hd));
+    for (const auto* list : { &g.playerSpawns, &g.ghostSpawns, &g.keys })
+        for (const auto& t : *list) {
+            int32_t xy[2] = { t.x, t.y };
+            f.write((const char*)xy, sizeof(xy));
+        }
+    std::vector<char> zero((size_t)(hd.chunkOffset - hd.tableOffset - tableBytes), 0);
+    f.write(zero.data(), (std::streamsize)zero.size());
+    f.write((const char*)g.words(), (std::streamsize)g.bytes());
+    if (!f) { if (err) *err = "write failed: " + path; return false; }
+    return true;
+}
+
+// ---------------- Mapped reader ----------------
+// เปิด .gwl แล้วคืน GWGrid ที่ชี้เข้า mapping ตรงๆ (copy เฉพาะตาราง spawn/key)
+static inline bool gw_openLevelFile(const std::string& path, GWGrid& out, std::string* err = nullptr) {
+    auto fail = [err](const std::string& m) { if (err) *err = m; return false; };
+    auto file = std::make_shared<GWMappedFile>();
+    if (!file->open(path)) return fail("cannot map " + path);
+
+    GWLevelHeader hd;
+    if (file->size < sizeof(hd)) return fail(path + ": truncated header");
+    std::memcpy(&hd, file->data, sizeof(hd));
+    if (hd.magic != GW_LEVEL_MAGIC) return fail(path + ": not a .gwl level");
+    if (hd.version != GW_LEVEL_VERSION) return fail(path + ": unsupported version " + std::to_string(hd.version));
+    // ขนาดต้องเช็คก่อน chunksFor (tiles + 2*PAD + CHUNK - 1 ล้น int ได้)
+    const int32_t maxTiles = INT32_MAX - 2 * GWGrid::PAD - GWGrid::CHUNK;
+    if (hd.width < 0 || hd.height < 0 || hd.width > maxTiles || hd.height > maxTiles)
+        return fail(path + ": bad size " + std::to_string(hd.width) + "x" + std::to_string(hd.height));
+    if (hd.chunkTiles != (uint32_t)GWGrid::CHUNK || hd.pad != (uint32_t)GWGrid::PAD ||
+        hd.chunksX != (uint32_t)GWGrid::chunksFor(hd.width) || hd.chunksY != (uint32_t)GWGrid::chunksFor(hd.height))
+        return fail(path + ": bad chunk layout");
+    // ทุกค่าไม่เกิน ~2^59 (chunksX/Y < 2^26, count < 2^32) จึงไม่ล้น uint64; offset เทียบแบบลบ กัน wraparound
+    uint64_t tableBytes = (uint64_t)hd.playerCount + hd.ghostCount + hd.keyCount;
+    tableBytes *= 2 * sizeof(int32_t);
+    uint64_t chunkBytes = (uint64_t)hd.chunksX * hd.chunksY * GWGrid::CHUNK * sizeof(uint64_t);
+    if (hd.tableOffset < sizeof(hd) || hd.tableOffset % sizeof(int32_t) != 0 || hd.tableOffset > hd.chunkOffset ||
+        tableBytes > hd.chunkOffset - hd.tableOffset || hd.chunkOffset % GW_LEVEL_ALIGN != 0 ||
+        chunkBytes > file->size || hd.chunkOffset > file->size - chunkBytes)
+        return fail(path + ": truncated or corrupt");
+
+    GWGrid g;
+    g.w = hd.width; g.h = hd.height;
+    g.cw = (int)hd.chunksX; g.ch = (int)hd.chunksY;
+    g.contentHash = hd.contentHash;
+    const int32_t* t = (const int32_t*)(file->data + hd.tableOffset);
+    // spawn/key ต้องอยู่ในแผนที่: world วาง entity ที่ tile เหล่านี้แล้วอ่าน wall() แบบไม่เช็ค bounds
+    auto readList = [&t, &g](std::vector<glm::ivec2>& list, uint32_t n) {
+        list.resize(n);
+        for (uint32_t i = 0; i < n; ++i, t += 2) {
+            list[i] = { t[0], t[1] };
+            if (!g.inside(list[i].x, list[i].y)) return false;
+        }
+        return true;
+    };
+    if (!readList(g.playerSpawns, hd.playerCount) || !readList(g.ghostSpawns, hd.ghostCount) ||
+        !readList(g.keys, hd.keyCount))
+        return fail(path + ": spawn/key outside the map");
+    // aliasing shared_ptr: ชี้ไปที่ chunk data แต่ถือ mapping ไว้ทั้งก้อน
+    g.mapped = std::shared_ptr<const uint64_t>(file, (const uint64_t*)(file->data + hd.chunkOffset));
+    out = std::move(g);
+    return true;
+}
+
+static inline bool gw_isLevelFile(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    uint32_t magic = 0;
+    return f.read((char*)&magic, sizeof(magic)) && magic == GW_LEVEL_MAGIC;
+}
+
+// ---------------- Residency ----------------
+// เก็บเฉพาะ chunk ในระยะ radius chunk (Chebyshev) รอบผู้เล่นไว้ในหน่วยความจำ. จำสี่เหลี่ยม chunk ที่ resident ไว้:
+// ตอนผู้เล่นเปลี่ยน chunk คืนหน้าของ chunk ที่หลุดออกไป และ prefetch เฉพาะ chunk ที่เพิ่งเข้ามา (งานตามขนาดขอบ ไม่ใช่ขนาดแผนที่).
+// grid ที่ไม่ได้ map ไม่ทำอะไร
+struct GWChunkResidency {
+    const uint64_t* lastData = nullptr;
+    int rx0 = 0, ry0 = 0, rx1 = -1, ry1 = -1;   // สี่เหลี่ยม chunk ที่ resident (รวมขอบ); ว่างเมื่อ rx1 < rx0
+
+    void update(const GWGrid& g, const glm::ivec2& tile, int radius) {
+        if (!g.mapped) return;
+        size_t c = g.chunkIndexOf(std::clamp(tile.x, -GWGrid::PAD, g.w), std::clamp(tile.y, -GWGrid::PAD, g.h));
+        const int pcx = (int)(c % (size_t)g.cw), pcy = (int)(c / (size_t)g.cw);
+        const int nx0 = std::max(0, pcx - radius), nx1 = std::min(g.cw - 1, pcx + radius);
+        const int ny0 = std::max(0, pcy - radius), ny1 = std::min(g.ch - 1, pcy + radius);
+
+        const size_t chunkBytes = GWGrid::CHUNK * sizeof(uint64_t);
+        const size_t total = (size_t)g.cw * g.ch;
+        const unsigned char* base = (const unsigned char*)g.mapped.get();
+        if (g.mapped.get() != lastData) {
+            // map ใหม่: load/flow field อาจแตะไปทั้งแผนที่แล้ว -> คืนทั้งก้อนทีเดียว แล้วเริ่มจากสี่เหลี่ยมว่าง
+            release(base, total * chunkBytes);
+            lastData = g.mapped.get();
+            rx0 = ry0 = 0; rx1 = ry1 = -1;
+        } else if (nx0 == rx0 && nx1 == rx1 && ny0 == ry0 && ny1 == ry1) {
+            return;
+        }
+
+        const size_t page = pageSize();
+        const size_t perPage = std::max<size_t>(1, page / chunkBytes);
+        auto inNew = [&](size_t i) {
+            int cx = (int)(i % (size_t)g.cw), cy = (int)(i / (size_t)g.cw);
+            return cx >= nx0 && cx <= nx1 && cy >= ny0 && cy <= ny1;
+        };
+        // chunk i0..i1 (แถวเดียวกัน) หลุดออก: หน้าหนึ่งมีหลาย chunk จึงคืนเฉพาะหน้าที่ไม่มี chunk ในสี่เหลี่ยมใหม่
+        auto releaseChunks = [&](size_t i0, size_t i1) {
+            size_t runStart = (size_t)-1, p1 = i1 / perPage;
+            for (size_t p = i0 / perPage; p <= p1 + 1; ++p) {
+                bool keep = p > p1;
+                for (size_t i = p * perPage; i < std::min(total, (p + 1) * perPage) && !keep; ++i) keep = inNew(i);
+                if (!keep && runStart == (size_t)-1) runStart = p;
+                if (keep && runStart != (size_t)-1) {
+                    release(base + runStart * page, std::min(p * page, total * chunkBytes) - runStart * page);
+                    runStart = (size_t)-1;
+                }
+            }
+        };
+        // ช่วง [a0, a1] ของแถว ที่ไม่อยู่ใน [b0, b1] (b ว่างได้)
+        auto outside = [](int a0, int a1, int b0, int b1, auto&& fn) {
+            if (a0 > a1) return;
+            if (b0 > b1 || b1 < a0 || b0 > a1) { fn(a0, a1); return; }
+            if (a0 < b0) fn(a0, b0 - 1);
+            if (a1 > b1) fn(b1 + 1, a1);
+        };
+
+        for (int cy = ry0; cy <= ry1; ++cy) {
+            bool rowIn = cy >= ny0 && cy <= ny1;
+            outside(rx0, rx1, rowIn ? nx0 : 0, rowIn ? nx1 : -1, [&](int x0, int x1) {
+                releaseChunks((size_t)cy * g.cw + x0, (size_t)cy * g.cw + x1);
+            });
+        }
+        for (int cy = ny0; cy <= ny1; ++cy) {
+            bool rowIn = cy >= ry0 && cy <= ry1;
+            outside(nx0, nx1, rowIn ? rx0 : 0, rowIn ? rx1 : -1, [&](int x0, int x1) {
+                prefetch(base + ((size_t)cy * g.cw + x0) * chunkBytes, (size_t)(x1 - x0 + 1) * chunkBytes);
+            });
+        }
+        rx0 = nx0; rx1 = nx1; ry0 = ny0; ry1 = ny1;
+    }
+
+private:
+    static size_t pageSize() {
+#if defined(_WIN32)
+        SYSTEM_INFO si; GetSystemInfo(&si);
+        return (size_t)si.dwPageSize;
+#else
+        return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    }
+    // ช่วงต้องเริ่มที่ขอบ page (chunk data เริ่มที่ GW_LEVEL_ALIGN)
+    static void release(const unsigned char* p, size_t bytes) {
+#if defined(_WIN32)
+        VirtualUnlock((LPVOID)p, bytes);                // หน้าที่ไม่ได้ lock: เอาออกจาก working set
+#else
+        madvise((void*)p, bytes, MADV_DONTNEED);
+#endif
+    }
+    static void prefetch(const unsigned char* p, size_t bytes) {
+#if defined(_WIN32)
+        (void)p; (void)bytes;                           // ให้ page fault โหลดเองตอนแตะ
+#else
+        size_t page = pageSize();
+        uintptr_t a = (uintptr_t)p / page * page;
+        madvise((void*)a, bytes + ((uintptr_t)p - a), MADV_WILLNEED);
+#endif
+    }
+};
@@ -0,0 +1,70 @@
+// Grid Walk 3D — read-only memory-mapped file
+// ใช้ร่วมกันระหว่างไฟล์ level (.gwl) กับ model cache (.gwm): map ทั้งไฟล์ครั้งเดียว, OS อ่านหน้าจริงตอนแตะ
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ไฟล์ที่ map ไว้ทั้งไฟล์ (read-only); unmap ใน destructor (ถือผ่าน shared_ptr ให้อยู่นานเท่าผู้ใช้ได้)
+struct GWMappedFile {
+    const unsigned char* data = nullptr;
+    uint64_t size = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+#endif
+
+    GWMappedFile() = default;
+    GWMappedFile(const GWMappedFile&) = delete;
+    GWMappedFile& operator=(const GWMappedFile&) = delete;
+
+    bool open(const std::string& path) {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file, &sz) || sz.QuadPart == 0) return false;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = (uint64_t)sz.QuadPart;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);                                     // mapping อยู่ต่อได้หลังปิด fd
+        if (p == MAP_FAILED) return false;
+        madvise(p, (size_t)st.st_size, MADV_RANDOM);     // อ่านเป็นจุดๆ ตาม chunk: ไม่ต้อง read-ahead ข้างเคียง
+        data = (const unsigned char*)p;
+        size = (uint64_t)st.st_size;
+#endif
+        return data != nullptr;
+    }
+
+    ~GWMappedFile() {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap((void*)data, (size_t)size);
+#endif
+    }
+};
@@ -0,0 +1,285 @@
+// Grid Walk 3D — preprocessed model cache (.gwm)
+// assimp + stb_image ทำครั้งเดียว: เก็บ vertex (pos/normal/uv interleaved), index, texture ของแต่ละ mesh
+// และ pixel ที่ decode แล้วลงไฟล์เดียว; ครั้งถัดไป mmap แล้วส่งเข้า VBO / texture ตรงๆ (ไม่มี GL ในไฟล์นี้)
+// cache ใช้ได้เมื่อ sourceHash ตรงกับ hash ของไฟล์ทุกไฟล์ในโฟลเดอร์ของ model (.obj/.mtl/texture)
+//
+// File layout (little-endian, ทุก section align 16):
+//   GWModelHeader
+//   GWModelMeshRecord[meshCount]          @ meshOffset
+//   GWModelTextureRecord[textureCount]    @ textureOffset
+//   vertices / indices / texture paths / pixels (ตาม offset ใน record)
+
+#pragma once
+
+#include "gw_mmap.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <stb_image.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <cstdint>
+#include <cstring>
+
+static const uint32_t GW_MODEL_MAGIC = 0x444D5747u;    // "GWMD"
+static const uint32_t GW_MODEL_VERSION = 1;
+
+struct GWModelVertex {
+    float pos[3];
+    float normal[3];
+    float uv[2];
+};
+static_assert(sizeof(GWModelVertex) == 32, "GWModelVertex is part of the file format");
+
+struct GWModelHeader {
+    uint32_t magic = GW_MODEL_MAGIC;
+    uint32_t version = GW_MODEL_VERSION;
+    uint64_t sourceHash = 0;
+    uint32_t meshCount = 0, textureCount = 0;
+    uint64_t meshOffset = 0, textureOffset = 0;
+    uint64_t fileBytes = 0;
+};
+struct GWModelMeshRecord {
+    uint64_t vertexOffset = 0, indexOffset = 0;
+    uint32_t vertexCount = 0, indexCount = 0;
+    int32_t  diffuse = -1;                     // index ใน texture table, -1 = ไม่มี
+    uint32_t reserved = 0;
+};
+struct GWModelTextureRecord {
+    uint64_t pixelOffset = 0, pixelBytes = 0;  // width * height * channels, แถวติดกัน (ไม่มี padding)
+    uint64_t pathOffset = 0;
+    uint32_t pathBytes = 0;                    // path ตาม .mtl (relative กับโฟลเดอร์ model)
+    int32_t  width = 0, height = 0, channels = 0;
+};
+static_assert(sizeof(GWModelHeader) == 48 && sizeof(GWModelMeshRecord) == 32 && sizeof(GWModelTextureRecord) == 40,
+    "model cache records are part of the file format");
+
+// ---------------- Source hash ----------------
+// FNV-1a ทีละ 8 byte ของทุกไฟล์ในโฟลเดอร์ (เรียงตามชื่อ, รวมชื่อไฟล์ด้วย): แก้ .obj/.mtl/texture ไฟล์ไหนก็ build ใหม่
+static inline uint64_t gw_hashBytes(uint64_t h, const unsigned char* p, size_t n) {
+    const uint64_t PRIME = 1099511628211ull;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, p + i, 8);
+        h = (h ^ v) * PRIME;
+    }
+    for (; i < n; ++i) h = (h ^ p[i]) * PRIME;
+    return h;
+}
+
+static inline uint64_t gw_hashModelSources(const std::string& modelPath) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (const auto& e : fs::directory_iterator(fs::path(modelPath).parent_path(), ec))
+        if (e.is_regular_file(ec)) files.push_back(e.path());
+    std::sort(files.begin(), files.end());
+
+    uint64_t h = 14695981039346656037ull ^ GW_MODEL_VERSION;
+    for (const auto& f : files) {
+        std::string name = f.filename().string();
+        h = gw_hashBytes(h, (const unsigned char*)name.data(), name.size());
+        GWMappedFile m;
+        if (m.open(f.string())) h = gw_hashBytes(h, m.data, (size_t)m.size);
+    }
+    return h;
+}
+
+// ---------------- Builder (assimp) ----------------
+// ขั้นตอนเดียวกับ LearnOpenGL Model: flags เดียวกัน, เดิน node แบบ recursive, texture ซ้ำ path ใช้ร่วมกัน
+// เก็บเฉพาะที่ shader ใช้: pos/normal/uv และ diffuse texture ตัวแรกของแต่ละ mesh
+static inline bool gw_buildModelCache(const std::string& modelPath, const std::string& cachePath, uint64_t sourceHash,
+    std::string* err = nullptr) {
+    auto fail = [err](const std::string& m) { if (err) *err = m; return false; };
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(modelPath,
+        aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+    if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode)
+        return fail("assimp: " + std::string(importer.GetErrorString()));
+    const std::string dir = modelPath.substr(0, modelPath.find_last_of("/\\"));
+
+    struct Tex { std::string path; int w = 0, h = 0, n = 0; std::vector<unsigned char> pixels; };
+    std::vector<Tex> textures;
+    std::vector<GWModelMeshRecord> meshes;
+    std::vector<std::vector<GWModelVertex>> verts;
+    std::vector<std::vector<uint32_t>> indices;
+
+    auto textureIndex = [&](const std::string& path) -> int {
+        for (size_t i = 0; i < textures.size(); ++i) if (textures[i].path == path) return (int)i;
+        Tex t; t.path = path;
+        unsigned char* px = stbi_load((dir + '/' + path).c_str(), &t.w, &t.h, &t.n, 0);
+        if (!px) return -1;                                  // เหมือน TextureFromFile: ไม่มีรูปก็วาดต่อได้
+        t.pixels.assign(px, px + (size_t)t.w * t.h * t.n);
+        stbi_image_free(px);
+        textures.push_back(std::move(t));
+        return (int)textures.size() - 1;
+    };
+
+    std::vector<const aiNode*> stack{ scene->mRootNode };
+    std::vector<const aiNode*> order;                        // pre-order เหมือน Model::processNode
+    while (!stack.empty()) {
+        const aiNode* n = stack.back(); stack.pop_back();
+        order.push_back(n);
+        for (unsigned i = n->mNumChildren; i > 0; --i) stack.push_back(n->mChildren[i - 1]);
+    }
+    for (const aiNode* node : order) {
+        for (unsigned mi = 0; mi < node->mNumMeshes; ++mi) {
+            const aiMesh* m = scene->mMeshes[node->mMeshes[mi]];
+            std::vector<GWModelVertex> v(m->mNumVertices);
+            for (unsigned i = 0; i < m->mNumVertices; ++i) {
+                GWModelVertex& o = v[i];
+                o.pos[0] = m->mVertices[i].x; o.pos[1] = m->mVertices[i].y; o.pos[2] = m->mVertices[i].z;
+                o.normal[0] = o.normal[1] = o.normal[2] = 0.0f;
+                if (m->HasNormals()) { o.normal[0] = m->mNormals[i].x; o.normal[1] = m->mNormals[i].y; o.normal[2] = m->mNormals[i].z; }
+                o.uv[0] = o.uv[1] = 0.0f;
+                if (m->mTextureCoords[0]) { o.uv[0] = m->mTextureCoords[0][i].x; o.uv[1] = m->mTextureCoords[0][i].y; }
+            }
+            std::vector<uint32_t> idx;
+            for (unsigned f = 0; f < m->mNumFaces; ++f)
+                for (unsigned k = 0; k < m->mFaces[f].mNumIndices; ++k) idx.push_back(m->mFaces[f].mIndices[k]);
+
+            GWModelMeshRecord rec;
+            rec.vertexCount = (uint32_t)v.size();
+            rec.indexCount = (uint32_t)idx.size();
+            const aiMaterial* mat = scene->mMaterials[m->mMaterialIndex];
+            if (mat->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
+                aiString str;
+                mat->GetTexture(aiTextureType_DIFFUSE, 0, &str);
+                rec.diffuse = textureIndex(str.C_Str());
+            }
+            meshes.push_back(rec);
+            verts.push_back(std::move(v));
+            indices.push_back(std::move(idx));
+        }
+    }
+
+    // วาง layout แล้วเขียนเป็นก้อนเดียว
+    std::vector<unsigned char> out;
+    auto align = [&out]() { out.resize((out.size() + 15) & ~(size_t)15, 0); };
+    auto append = [&out](const void* p, size_t n) -> uint64_t {
+        uint64_t at = out.size();
+        out.insert(out.end(), (const unsigned char*)p, (const unsigned char*)p + n);
+        return at;
+    };
+    GWModelHeader hd;
+    hd.sourceHash = sourceHash;
+    hd.meshCount = (uint32_t)meshes.size();
+    hd.textureCount = (uint32_t)textures.size();
+    out.resize(sizeof(hd), 0);
+    align(); hd.meshOffset = out.size();
+    out.resize(out.size() + meshes.size() * sizeof(GWModelMeshRecord), 0);
+    align(); hd.textureOffset = out.size();
+    out.resize(out.size() + textures.size() * sizeof(GWModelTextureRecord), 0);
+
+    std::vector<GWModelTextureRecord> texRecs(textures.size());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        align(); meshes[i].vertexOffset = append(verts[i].data(), verts[i].size() * sizeof(GWModelVertex));
+        align(); meshes[i].indexOffset = append(indices[i].data(), indices[i].size() * sizeof(uint32_t));
+    }
+    for (size_t i = 0; i < textures.size(); ++i) {
+        GWModelTextureRecord& r = texRecs[i];
+        r.width = textures[i].w; r.height = textures[i].h; r.channels = textures[i].n;
+        r.pathBytes = (uint32_t)textures[i].path.size();
+        r.pathOffset = append(textures[i].path.data(), r.pathBytes);
+        align(); r.pixelOffset = append(textures[i].pixels.data(), textures[i].pixels.size());
+        r.pixelBytes = textures[i].pixels.size();
+    }
+    hd.fileBytes = out.size();
+    std::memcpy(out.data(), &hd, sizeof(hd));
+    if (!meshes.empty()) std::memcpy(out.data() + hd.meshOffset, meshes.data(), meshes.size() * sizeof(GWModelMeshRecord));
+    if (!texRecs.empty()) std::memcpy(out.data() + hd.textureOffset, texRecs.data(), texRecs.size() * sizeof(GWModelTextureRecord));
+
+    // เขียนไฟล์ชั่วคราวแล้ว rename: ถ้าหยุดกลางทางจะไม่เหลือ cache ครึ่งไฟล์
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+    const std::string tmp = cachePath + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f || !f.write((const char*)out.data(), (std::streamsize)out.size())) return fail("cannot write " + tmp);
+    }
+    std::filesystem::rename(tmp, cachePath, ec);
+    if (ec) return fail("cannot rename " + tmp + ": " + ec.message());
+    return true;
+}
+
+// ---------------- Reader ----------------
+// ชี้เข้า mapping ตรงๆ: vertex/index/pixel ส่งให้ glBufferData / glTexImage2D ได้เลย
+struct GWModelCache {
+    std::shared_ptr<GWMappedFile> file;
+    const GWModelHeader* header = nullptr;
+    const GWModelMeshRecord* meshes = nullptr;
+    const GWModelTextureRecord* textures = nullptr;
+
+    // false ถ้าไม่มีไฟล์, เสีย, หรือ hash ของ source ไม่ตรง (ต้อง build ใหม่)
+    bool open(const std::string& cachePath, uint64_t sourceHash) {
+        auto f = std::make_shared<GWMappedFile>();
+        if (!f->open(cachePath) || f->size < sizeof(GWModelHeader)) return false;
+        const GWModelHeader* hd = (const GWModelHeader*)f->data;
+        if (hd->magic != GW_MODEL_MAGIC || hd->version != GW_MODEL_VERSION || hd->sourceHash != sourceHash ||
+            hd->fileBytes != f->size)
+            return false;
+        if (hd->meshOffset + (uint64_t)hd->meshCount * sizeof(GWModelMeshRecord) > f->size ||
+            hd->textureOffset + (uint64_t)hd->textureCount * sizeof(GWModelTextureRecord) > f->size)
+            return false;
+        const GWModelMeshRecord* m = (const GWModelMeshRecord*)(f->data + hd->meshOffset);
+        const GWModelTextureRecord* t = (const GWModelTextureRecord*)(f->data + hd->textureOffset);
+        for (uint32_t i = 0; i < hd->meshCount; ++i) {
+            if (m[i].vertexOffset + (uint64_t)m[i].vertexCount * sizeof(GWModelVertex) > f->size ||
+                m[i].indexOffset + (uint64_t)m[i].indexCount * sizeof(uint32_t) > f->size ||
+                m[i].diffuse >= (int32_t)hd->textureCount)
+                return false;
+        }
+        for (uint32_t i = 0; i < hd->textureCount; ++i) {
+            if (t[i].pixelOffset + t[i].pixelBytes > f->size || t[i].pathOffset + t[i].pathBytes > f->size ||
+                t[i].pixelBytes != (uint64_t)t[i].width * t[i].height * t[i].channels)
+                return false;
+        }
+        file = std::move(f);
+        header = hd; meshes = m; textures = t;
+        return true;
+    }
+
+    const GWModelVertex* vertices(uint32_t mesh) const { return (const GWModelVertex*)(file->data + meshes[mesh].vertexOffset); }
+    const uint32_t* indices(uint32_t mesh) const { return (const uint32_t*)(file->data + meshes[mesh].indexOffset); }
+    const unsigned char* pixels(uint32_t tex) const { return file->data + textures[tex].pixelOffset; }
+    std::string texturePath(uint32_t tex) const {
+        return std::string((const char*)file->data + textures[tex].pathOffset, textures[tex].pathBytes);
+    }
+};
+
+// ---------------- Prepare (worker thread) ----------------
+// ทุกอย่างก่อนแตะ GL: hash source, map cache หรือ build ใหม่ด้วย assimp/stb — เรียกจาก thread ไหนก็ได้
+// (Assimp::Importer แยกต่อการเรียก, stb_image ไม่มี state ร่วมที่เราใช้)
+struct GWModelPrep {
+    GWModelCache cache;
+    bool ok = false, hit = false;
+    double hashMs = 0.0, loadMs = 0.0;         // loadMs = map (hit) หรือ assimp + เขียน cache (miss)
+    std::string error;
+};
+
+static inline GWModelPrep gw_prepareModel(const std::string& modelPath, const std::string& cachePath, bool useCache) {
+    using Clock = std::chrono::steady_clock;
+    GWModelPrep r;
+    auto t0 = Clock::now();
+    uint64_t hash = gw_hashModelSources(modelPath);
+    auto t1 = Clock::now();
+    r.hit = useCache && r.cache.open(cachePath, hash);
+    if (!r.hit) {
+        if (!gw_buildModelCache(modelPath, cachePath, hash, &r.error)) return r;
+        if (!r.cache.open(cachePath, hash)) { r.error = "cannot reopen " + cachePath; return r; }
+    }
+    auto t2 = Clock::now();
+    r.hashMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    r.loadMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    r.ok = true;
+    return r;
+}
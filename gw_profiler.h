@@ -0,0 +1,184 @@
+// Grid Walk 3D — per-phase frame profiler
+// CPU: GWProfileScope จับเวลาเฟสของ main loop / GWWorld::step (ไม่มี profiler = ไม่จับ, แค่เช็ค nullptr)
+// GPU: ฝั่ง app ส่งเวลาจาก timer query เข้ามาทีหลัง (ช้ากว่าเฟรมจริง GW_PROF_LAG เฟรม) ด้วย setGpu
+// state change (program/VAO/texture ที่ bind จริง) นับแยกไว้ดูผลของ render queue
+// allocation ต่อเฟรม: ฝั่ง app วัดจาก gw_alloc.h แล้วส่งเข้ามาด้วย countAllocs (steady state ควรเป็น 0)
+// ไม่มี GL ในไฟล์นี้; สรุปแบบ rolling ทุกช่วงเวลา และเขียน CSV 1 แถวต่อเฟรมเมื่อผล GPU ของเฟรมนั้นครบแล้ว
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+enum GWProfPhase {
+    GW_PROF_INPUT, GW_PROF_PLAYER, GW_PROF_GHOSTS, GW_PROF_BULLETS, GW_PROF_COLLISIONS,
+    GW_PROF_CAMERA, GW_PROF_RENDER, GW_PROF_CAPTURE,
+    GW_PROF_CPU_COUNT
+};
+enum GWProfGpu {
+    GW_GPU_LEVEL, GW_GPU_MODELS, GW_GPU_SPHERES,
+    GW_GPU_COUNT
+};
+enum GWProfState {
+    GW_STATE_PROGRAM, GW_STATE_VAO, GW_STATE_TEXTURE,
+    GW_STATE_COUNT
+};
+static const char* const GW_PROF_CPU_NAMES[GW_PROF_CPU_COUNT] = { "input", "player", "ghosts", "bullets", "collisions", "camera", "render", "capture" };
+static const char* const GW_PROF_GPU_NAMES[GW_GPU_COUNT] = { "gpu_level", "gpu_models", "gpu_spheres" };
+static const char* const GW_PROF_STATE_NAMES[GW_STATE_COUNT] = { "program_binds", "vao_binds", "texture_binds" };
+
+static const int GW_PROF_LAG = 4;           // เฟรมที่รอผล GPU ก่อนอ่าน (ขนาด ring ของ query)
+static const int GW_PROF_WINDOW = 120;      // จำนวนเฟรมของค่าเฉลี่ยแบบ rolling
+
+struct GWFrameStats {
+    uint64_t frame = 0;
+    double   frameMs = 0.0;
+    double   cpuMs[GW_PROF_CPU_COUNT] = {};
+    double   gpuMs[GW_GPU_COUNT] = {};  // < 0 = ไม่มีผล (query ไม่ได้ออก/ยังไม่พร้อม)
+    uint32_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint32_t uniformUploads = 0;
+    uint32_t stateChanges[GW_STATE_COUNT] = {};
+    uint32_t allocs = 0;
+};
+
+class GWProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ~GWProfiler() { if (csv) std::fclose(csv); }
+
+    bool openCsv(const std::string& path) {
+        csv = std::fopen(path.c_str(), "w");
+        if (!csv) return false;
+        std::fprintf(csv, "frame,frame_ms");
+        for (const char* n : GW_PROF_CPU_NAMES) std::fprintf(csv, ",%s", n);
+        for (const char* n : GW_PROF_GPU_NAMES) std::fprintf(csv, ",%s", n);
+        std::fprintf(csv, ",draws,triangles,uniforms");
+        for (const char* n : GW_PROF_STATE_NAMES) std::fprintf(csv, ",%s", n);
+        std::fprintf(csv, ",allocs\n");
+        return true;
+    }
+
+    void beginFrame() {
+        frameStart = Clock::now();
+        cur = GWFrameStats{};
+        cur.frame = frameIndex;
+        for (double& g : cur.gpuMs) g = -1.0;
+    }
+    // ปิดเฟรม: เก็บเข้า ring รอผล GPU, เฟรมที่เก่ากว่า GW_PROF_LAG ถือว่าครบแล้ว -> รวมค่าเฉลี่ย + เขียน CSV
+    void endFrame() {
+        cur.frameMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+        GWFrameStats& slot = pending[frameIndex % GW_PROF_LAG];
+        if (frameIndex >= (uint64_t)GW_PROF_LAG) retire(slot);
+        slot = cur;
+        ++frameIndex;
+    }
+
+    uint64_t frame() const { return frameIndex; }
+    const GWFrameStats& current() const { return cur; }      // เฟรมที่กำลังจับ (ก่อน endFrame)
+    void addCpu(GWProfPhase p, double ms) { cur.cpuMs[p] += ms; }
+    void countDraw(uint64_t triangles) { ++cur.drawCalls; cur.triangles += triangles; }
+    void countUniforms(uint32_t n = 1) { cur.uniformUploads += n; }
+    void countState(GWProfState s) { ++cur.stateChanges[s]; }
+    void countAllocs(uint64_t n) { cur.allocs += (uint32_t)n; }
+
+    // ผลของ query ที่ออกในเฟรม frame (ยังอยู่ใน ring ถ้าไม่เก่ากว่า GW_PROF_LAG)
+    void setGpu(uint64_t frame, GWProfGpu p, double ms) {
+        GWFrameStats& s = pending[frame % GW_PROF_LAG];
+        if (s.frame == frame) s.gpuMs[p] = ms;
+    }
+
+    // ค่าเฉลี่ยของ GW_PROF_WINDOW เฟรมล่าสุดที่ครบแล้ว (ms / จำนวนต่อเฟรม)
+    const GWFrameStats& average() const { return avg; }
+    double averageAllocs() const { return avgAllocs; }
+
+    // บรรทัดสรุปสั้นๆ สำหรับ title bar / console
+    std::string summary() const {
+        char buf[512];
+        int n = std::snprintf(buf, sizeof(buf), "%.2f ms (%.0f fps) |", avg.frameMs, avg.frameMs > 0.0 ? 1000.0 / avg.frameMs : 0.0);
+        for (int i = 0; i < GW_PROF_CPU_COUNT && n < (int)sizeof(buf); ++i)
+            n += std::snprintf(buf + n, sizeof(buf) - n, " %s %.2f", GW_PROF_CPU_NAMES[i], avg.cpuMs[i]);
+        for (int i = 0; i < GW_GPU_COUNT && n < (int)sizeof(buf); ++i)
+            n += std::snprintf(buf + n, sizeof(buf) - n, " %s %.2f", GW_PROF_GPU_NAMES[i], avg.gpuMs[i]);
+        if (n < (int)sizeof(buf))
+            std::snprintf(buf + n, sizeof(buf) - n, " | %u draws %llu tris %u uniforms | binds prog %u vao %u tex %u | %.2f allocs",
+                avg.drawCalls, (unsigned long long)avg.triangles, avg.uniformUploads,
+                avg.stateChanges[GW_STATE_PROGRAM], avg.stateChanges[GW_STATE_VAO], avg.stateChanges[GW_STATE_TEXTURE], avgAllocs);
+        return buf;
+    }
+
+private:
+    void retire(const GWFrameStats& s) {
+        if (csv) {
+            std::fprintf(csv, "%llu,%.4f", (unsigned long long)s.frame, s.frameMs);
+            for (double v : s.cpuMs) std::fprintf(csv, ",%.4f", v);
+            for (double v : s.gpuMs) std::fprintf(csv, ",%.4f", v);
+            std::fprintf(csv, ",%u,%llu,%u", s.drawCalls, (unsigned long long)s.triangles, s.uniformUploads);
+            for (uint32_t v : s.stateChanges) std::fprintf(csv, ",%u", v);
+            std::fprintf(csv, ",%u\n", s.allocs);
+        }
+        // rolling: ลบเฟรมที่หลุดหน้าต่างออกจากผลรวม แล้วบวกเฟรมใหม่
+        GWFrameStats& old = window[windowCount % GW_PROF_WINDOW];
+        if (windowCount >= (uint64_t)GW_PROF_WINDOW) accumulate(old, -1.0);
+        old = s;
+        accumulate(s, 1.0);
+        ++windowCount;
+        const double n = (double)std::min<uint64_t>(windowCount, GW_PROF_WINDOW);
+        avg.frame = s.frame;
+        avg.frameMs = sum.frameMs / n;
+        for (int i = 0; i < GW_PROF_CPU_COUNT; ++i) avg.cpuMs[i] = sum.cpuMs[i] / n;
+        for (int i = 0; i < GW_GPU_COUNT; ++i) avg.gpuMs[i] = gpuSamples[i] > 0 ? sum.gpuMs[i] / gpuSamples[i] : -1.0;
+        avg.drawCalls = (uint32_t)(sumDraws / n + 0.5);
+        avg.triangles = (uint64_t)(sumTris / n + 0.5);
+        avg.uniformUploads = (uint32_t)(sumUniforms / n + 0.5);
+        for (int i = 0; i < GW_STATE_COUNT; ++i) avg.stateChanges[i] = (uint32_t)(sumState[i] / n + 0.5);
+        avgAllocs = sumAllocs / n;
+        avg.allocs = (uint32_t)(avgAllocs + 0.5);
+    }
+    void accumulate(const GWFrameStats& s, double sign) {
+        sum.frameMs += sign * s.frameMs;
+        for (int i = 0; i < GW_PROF_CPU_COUNT; ++i) sum.cpuMs[i] += sign * s.cpuMs[i];
+        for (int i = 0; i < GW_GPU_COUNT; ++i)
+            if (s.gpuMs[i] >= 0.0) { sum.gpuMs[i] += sign * s.gpuMs[i]; gpuSamples[i] += (int)sign; }
+        sumDraws += sign * s.drawCalls;
+        sumTris += sign * (double)s.triangles;
+        sumUniforms += sign * s.uniformUploads;
+        for (int i = 0; i < GW_STATE_COUNT; ++i) sumState[i] += sign * s.stateChanges[i];
+        sumAllocs += sign * s.allocs;
+    }
+
+    Clock::time_point frameStart;
+    uint64_t frameIndex = 0;
+    GWFrameStats cur;
+    GWFrameStats pending[GW_PROF_LAG];
+    GWFrameStats window[GW_PROF_WINDOW];
+    uint64_t windowCount = 0;
+    GWFrameStats sum, avg;
+    int gpuSamples[GW_GPU_COUNT] = {};
+    double sumDraws = 0.0, sumTris = 0.0, sumUniforms = 0.0;
+    double sumState[GW_STATE_COUNT] = {};
+    double sumAllocs = 0.0, avgAllocs = 0.0;     // ค่าเฉลี่ยไม่ปัด: allocation นานๆ ครั้งยังเห็นได้
+    FILE* csv = nullptr;
+};
+
+// จับเวลา CPU ของ scope; p = nullptr -> ไม่ทำอะไร (headless / ปิด profiler)
+struct GWProfileScope {
+    GWProfiler* p;
+    GWProfPhase phase;
+    GWProfiler::Clock::time_point t0;
+
+    GWProfileScope(GWProfiler* prof, GWProfPhase ph) : p(prof), phase(ph) { if (p) t0 = GWProfiler::Clock::now(); }
+    ~GWProfileScope() { stop(); }
+    // ปิดก่อนจบ scope (เฟสที่อยู่กลางฟังก์ชันยาวๆ); เรียกซ้ำได้
+    void stop() {
+        if (p) p->addCpu(phase, std::chrono::duration<double, std::milli>(GWProfiler::Clock::now() - t0).count());
+        p = nullptr;
+    }
+    GWProfileScope(const GWProfileScope&) = delete;
+    GWProfileScope& operator=(const GWProfileScope&) = delete;
+};
@@ -0,0 +1,154 @@
+// Grid Walk 3D — input recording / replay (.gwr)
+// sim เป็น fixed tick และไม่มีตัวสุ่ม: input ต่อ tick + แผนที่เดิม = session เดิมทุก bit
+// recorder เก็บ input ที่ step ใช้จริง (หลังรวม fire edge ใน gw_advance) + hash 32 bit ของ world หลัง tick นั้น
+// replay (tools/gw_headless --replay) รันเต็มความเร็วโดยไม่มีหน้าต่าง แล้วเทียบ hash ทุก tick
+//
+// File layout (little-endian):
+//   GWReplayHeader
+//   map path (pathBytes, ไม่มี '\0'; ว่าง = GW_DEFAULT_MAP)
+//   5 B ต่อ tick: uint8 input (bit 0-1 dir.x+1, bit 2-3 dir.y+1, bit 4 fire) + uint32 (low 32 bit ของ gw_worldHash)
+//   จำนวน tick ดูจากขนาดไฟล์: เกมปิดกลางคันก็ยังเล่นซ้ำได้ถึง tick ที่ flush ล่าสุด
+
+#pragma once
+
+#include "gw_world.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static const uint32_t GW_REPLAY_MAGIC = 0x52575747u;      // "GWWR"
+static const uint32_t GW_REPLAY_VERSION = 1;
+static const size_t GW_REPLAY_TICK_BYTES = 5;
+
+struct GWReplayHeader {
+    uint32_t magic = GW_REPLAY_MAGIC;
+    uint32_t version = GW_REPLAY_VERSION;
+    float    fixedDt = GW_SIM_DT;
+    uint32_t seed = 0;              // seed ของแผนที่ procedural (0 = แผนที่จากไฟล์/ในตัว)
+    uint64_t mapHash = 0;           // GWGrid::hash()
+    int32_t  mapW = 0, mapH = 0;
+    uint32_t pathBytes = 0;
+    uint32_t reserved = 0;
+};
+static_assert(sizeof(GWReplayHeader) == 40, "GWReplayHeader is part of the file format");
+
+static inline uint8_t gw_packInput(const GWInputState& in) {
+    return (uint8_t)((in.dir.x + 1) | (in.dir.y + 1) << 2 | (in.fire ? 16 : 0));
+}
+static inline GWInputState gw_unpackInput(uint8_t b) {
+    GWInputState in;
+    in.dir = { (int)(b & 3) - 1, (int)(b >> 2 & 3) - 1 };
+    in.fire = (b & 16) != 0;
+    return in;
+}
+
+// ---------------- Recorder ----------------
+// เปิดก่อน tick แรกของ world ที่เพิ่ง load; tick() หลังทุก step (ใช้เป็น onTick ของ gw_advance)
+class GWReplayWriter {
+public:
+    ~GWReplayWriter() { close(); }
+
+    bool open(const std::string& path, const GWWorld& w, const std::string& mapPath, uint32_t seed, float fixedDt,
+        std::string* err = nullptr) {
+        GWReplayHeader hd;
+        hd.fixedDt = fixedDt;
+        hd.seed = seed;
+        hd.mapHash = w.grid.hash();
+        hd.mapW = w.grid.w; hd.mapH = w.grid.h;
+        hd.pathBytes = (uint32_t)mapPath.size();
+        f.open(path, std::ios::binary | std::ios::trunc);
+        if (!f) { if (err) *err = "cannot create " + path; return false; }
+        f.write((const char*)&hd, sizeof(hd));
+        f.write(mapPath.data(), (std::streamsize)mapPath.size());
+        buf.reserve(FLUSH_TICKS * GW_REPLAY_TICK_BYTES);
+        count = 0;
+        return (bool)f;
+    }
+
+    bool active() const { return f.is_open(); }
+    uint64_t ticks() const { return count; }
+
+    void tick(const GWInputState& in, const GWWorld& w) {
+        if (!f.is_open()) return;
+        uint32_t h = (uint32_t)gw_worldHash(w);
+        unsigned char rec[GW_REPLAY_TICK_BYTES] = { gw_packInput(in) };
+        std::memcpy(rec + 1, &h, 4);
+        buf.insert(buf.end(), rec, rec + GW_REPLAY_TICK_BYTES);
+        if (++count % FLUSH_TICKS == 0) flush();
+    }
+
+    void close() {
+        if (!f.is_open()) return;
+        flush();
+        f.close();
+    }
+
+private:
+    enum { FLUSH_TICKS = 1024 };     // ~17 วินาทีที่ 60 Hz
+    void flush() {
+        f.write((const char*)buf.data(), (std::streamsize)buf.size());
+        f.flush();
+        buf.clear();
+    }
+
+    std::ofstream f;
+    std::vector<unsigned char> buf;
+    uint64_t count = 0;
+};
+
+// ---------------- Reader / runner ----------------
+struct GWReplay {
+    GWReplayHeader header;
+    std::string mapPath;
+    std::vector<uint8_t> inputs;
+    std::vector<uint32_t> hashes;
+
+    size_t ticks() const { return inputs.size(); }
+
+    bool load(const std::string& path, std::string* err = nullptr) {
+        auto fail = [err](const std::string& m) { if (err) *err = m; return false; };
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return fail("cannot read " + path);
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        if (data.size() < sizeof(header)) return fail(path + ": truncated header");
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.magic != GW_REPLAY_MAGIC) return fail(path + ": not a .gwr replay");
+        if (header.version != GW_REPLAY_VERSION) return fail(path + ": unsupported version " + std::to_string(header.version));
+        size_t off = sizeof(header) + header.pathBytes;
+        if (off > data.size()) return fail(path + ": truncated map path");
+        mapPath.assign((const char*)data.data() + sizeof(header), header.pathBytes);
+
+        const size_t n = (data.size() - off) / GW_REPLAY_TICK_BYTES;   // record สุดท้ายที่ไม่ครบถูกตัดทิ้ง
+        inputs.resize(n); hashes.resize(n);
+        for (size_t i = 0; i < n; ++i, off += GW_REPLAY_TICK_BYTES) {
+            inputs[i] = data[off];
+            std::memcpy(&hashes[i], data.data() + off + 1, 4);
+        }
+        return true;
+    }
+};
+
+struct GWReplayResult {
+    uint64_t ticks = 0;             // tick ที่รันแล้ว
+    int64_t  divergedAt = -1;       // index ของ tick แรกที่ hash ไม่ตรง (-1 = ตรงทุก tick)
+    uint32_t expected = 0, actual = 0;
+};
+
+// w ต้องเพิ่ง load แผนที่เดียวกับตอนอัด (เช็ค header.mapHash ก่อนเรียก); หยุดที่ tick แรกที่ต่าง
+static inline GWReplayResult gw_runReplay(GWWorld& w, const GWReplay& r) {
+    GWReplayResult res;
+    for (size_t t = 0; t < r.ticks(); ++t) {
+        w.step(r.header.fixedDt, gw_unpackInput(r.inputs[t]));
+        ++res.ticks;
+        uint32_t h = (uint32_t)gw_worldHash(w);
+        if (h != r.hashes[t]) {
+            res.divergedAt = (int64_t)t; res.expected = r.hashes[t]; res.actual = h;
+            break;
+        }
+    }
+    return res;
+}
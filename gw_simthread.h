@@ -0,0 +1,241 @@
+// Grid Walk 3D — simulation thread + render snapshots
+// sim รันบน thread ของตัวเองที่ fixed rate; หลังทุก tick copy สถานะที่ต้องวาดลง GWSnapshot แล้ว publish ผ่าน triple buffer
+// (lock-free: writer กับ reader ไม่เคยรอกัน, reader ได้ snapshot ล่าสุดเสมอ) และรับ input จาก render thread ผ่าน SPSC queue
+// snapshot เก็บทั้งตำแหน่ง tick ก่อนหน้าและ tick นี้: render interpolate ระหว่างสอง tick ล่าสุดได้จาก snapshot เดียว
+// โหมด inline (ไม่มี thread: GW_SIM_THREAD=0, --bench) publish ผ่าน buffer เดียวกัน -> โค้ดวาดมีทางเดียว
+// ไม่มี GL ในไฟล์นี้
+
+#pragma once
+
+#include "gw_world.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// ---------------- Snapshot ----------------
+// ตัวนับสะสมตั้งแต่เริ่ม (ไม่ใช่ต่อ tick): render อาจข้าม snapshot ได้ จึงดูผลต่างจากครั้งก่อนแทน
+struct GWSnapshot {
+    uint64_t tick = 0;
+    std::chrono::steady_clock::time_point published;
+
+    glm::vec2  playerPrev{ 0 }, playerPos{ 0 };
+    float      playerYaw = 0.f;
+    glm::ivec2 playerDir{ 0 };
+    bool       hasGun = false;
+
+    std::vector<float> ghostPrevX, ghostPrevY, ghostX, ghostY, ghostYaw;
+    std::vector<float> bulletPrevX, bulletPrevY, bulletX, bulletY;     // เฉพาะนัดที่ยัง alive
+    std::vector<uint8_t> keyTaken;
+
+    uint64_t gunsPicked = 0, ghostsShot = 0, caught = 0;
+    double   simMs[GW_PROF_CPU_COUNT] = {};                            // เวลาเฟสของ sim สะสม (ms)
+
+    size_t     ghostCount() const { return ghostX.size(); }
+    glm::vec2  ghostPos(size_t i, float alpha) const {
+        return gw_lerpPos({ ghostPrevX[i], ghostPrevY[i] }, { ghostX[i], ghostY[i] }, alpha);
+    }
+    size_t     bulletCount() const { return bulletX.size(); }
+    glm::vec2  bulletPos(size_t i, float alpha) const {
+        return gw_lerpPos({ bulletPrevX[i], bulletPrevY[i] }, { bulletX[i], bulletY[i] }, alpha);
+    }
+};
+
+// copy ลง slot เดิม: vector ใช้ capacity ที่มีอยู่ (หลังช่วงแรกไม่ allocate)
+static inline void gw_captureSnapshot(const GWWorld& w, GWSnapshot& s) {
+    s.tick = w.tick;
+    s.published = std::chrono::steady_clock::now();
+    s.playerPrev = w.player.prevPos; s.playerPos = w.player.pos;
+    s.playerYaw = w.player.yaw; s.playerDir = w.player.ctrl.dir;
+    s.hasGun = w.hasGun;
+    const GWGhosts& g = w.ghosts;
+    s.ghostPrevX.assign(g.prevX.begin(), g.prevX.end()); s.ghostPrevY.assign(g.prevY.begin(), g.prevY.end());
+    s.ghostX.assign(g.x.begin(), g.x.end()); s.ghostY.assign(g.y.begin(), g.y.end());
+    s.ghostYaw.assign(g.yaw.begin(), g.yaw.end());
+    const GWBullets& b = w.bullets;
+    s.bulletPrevX.clear(); s.bulletPrevY.clear(); s.bulletX.clear(); s.bulletY.clear();
+    for (size_t i = 0; i < b.slots(); ++i) {
+        if (!b.alive[i]) continue;
+        s.bulletPrevX.push_back(b.prevX[i]); s.bulletPrevY.push_back(b.prevY[i]);
+        s.bulletX.push_back(b.x[i]); s.bulletY.push_back(b.y[i]);
+    }
+    s.keyTaken.assign(w.keyTaken.begin(), w.keyTaken.end());
+}
+
+// ---------------- Triple buffer ----------------
+// 3 slot: writer เป็นเจ้าของ back, reader เป็นเจ้าของ front, middle สลับด้วย atomic exchange
+// bit DIRTY บน middle = มีของใหม่ที่ reader ยังไม่ได้หยิบ
+template<class T>
+class GWTripleBuffer {
+public:
+    T&       writeBuffer() { return slots[back]; }
+    const T& readBuffer() const { return slots[front]; }
+
+    void publish() {
+        back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX;
+    }
+    // true = ได้ snapshot ใหม่ตั้งแต่ครั้งก่อน (ไม่งั้น readBuffer() เป็นอันเดิม)
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & DIRTY)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+private:
+    enum : uint32_t { INDEX = 3, DIRTY = 4 };
+    T slots[3];
+    std::atomic<uint32_t> middle{ 1 };
+    uint32_t back = 0, front = 2;
+};
+
+// ---------------- SPSC queue ----------------
+// ring ขนาด N (ยกกำลังสอง) สำหรับ producer 1 ตัว / consumer 1 ตัว; เต็ม -> push คืน false
+template<class T, size_t N>
+class GWSpscQueue {
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+public:
+    bool push(const T& v) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) return false;
+        buf[t & (N - 1)] = v;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& v) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        v = buf[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T buf[N];
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
+
+// ---------------- Runner ----------------
+// เจ้าของการเดิน world: start() = thread แยกที่ fixed rate, ไม่ start = advanceInline() ทุกเฟรมบน thread ที่เรียก
+// ระหว่าง thread รัน ห้ามแตะ world จากที่อื่น (ยกเว้น grid/mapRev ซึ่งไม่เปลี่ยนหลัง load)
+class GWSimRunner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    std::function<void(const GWInputState&, const GWWorld&)> onTick;   // หลังทุก step (เช่น recorder)
+
+    explicit GWSimRunner(GWWorld& w, float fixedDt = GW_SIM_DT) : world(w), dt(fixedDt) {
+        clock.fixedDt = fixedDt;
+        world.prof = &prof;
+        publish();
+    }
+    ~GWSimRunner() { stop(); }
+    GWSimRunner(const GWSimRunner&) = delete;
+    GWSimRunner& operator=(const GWSimRunner&) = delete;
+
+    void start() {
+        if (thread.joinable()) return;
+        quit.store(false, std::memory_order_relaxed);
+        thread = std::thread([this] { run(); });
+    }
+    void stop() {
+        if (!thread.joinable()) return;
+        quit.store(true, std::memory_order_release);
+        thread.join();
+    }
+    bool threaded() const { return thread.joinable(); }
+
+    // render thread: ส่งเฉพาะเมื่อทิศเปลี่ยนหรือกดยิง (ทิศค้างไว้จนกว่าจะเปลี่ยน)
+    void pushInput(const GWInputState& in) {
+        if (in.dir == lastSent && !in.fire) return;
+        if (inputs.push(in)) lastSent = in.dir;
+    }
+
+    // โหมด inline: เดิน tick ตามเวลาเฟรม (gw_advance) แล้ว publish ถ้ามี tick ใหม่
+    void advanceInline(float frameDt, const GWInputState& in) {
+        prof.beginFrame();
+        gw_advance(world, clock, frameDt, in, [this](const GWInputState& ti) { afterTick(ti); });
+        prof.endFrame();
+        addPhases();
+        if (world.tick != snapTick) publish();
+    }
+
+    // snapshot ล่าสุด (render thread)
+    const GWSnapshot& latest() { snaps.acquire(); return snaps.readBuffer(); }
+
+    // สัดส่วนระหว่าง tick ก่อนหน้ากับ tick ของ snapshot
+    float alpha(const GWSnapshot& s) const {
+        if (!threaded()) return clock.alpha;
+        float a = std::chrono::duration<float>(Clock::now() - s.published).count() / dt;
+        return std::min(std::max(a, 0.0f), 1.0f);
+    }
+
+private:
+    void run() {
+        Clock::time_point next = Clock::now();
+        const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+        const auto maxLag = std::chrono::milliseconds(250);     // กัน spiral of death เหมือน GWSimClock::maxFrame
+        GWInputState held;
+        while (!quit.load(std::memory_order_acquire)) {
+            next += step;
+            Clock::time_point now = Clock::now();
+            if (now - next > maxLag) next = now;
+            else std::this_thread::sleep_until(next);
+
+            // input ที่ค้างใน queue: ทิศล่าสุดที่ไม่ใช่ (0,0) ชนะ (กดแล้วปล่อยภายใน tick เดียวก็ไม่หาย),
+            // กดยิงครั้งไหนก็ได้ใน tick นี้; held = สถานะปุ่มจริงหลังข้อความสุดท้าย
+            GWInputState in, ti;
+            bool any = false;
+            glm::ivec2 pressed{ 0 };
+            while (inputs.pop(in)) {
+                any = true;
+                held.dir = in.dir;
+                if (in.dir != glm::ivec2(0)) pressed = in.dir;
+                ti.fire = ti.fire || in.fire;
+            }
+            ti.dir = !any ? held.dir : pressed;
+
+            prof.beginFrame();
+            world.step(dt, ti);
+            prof.endFrame();
+            addPhases();
+            afterTick(ti);
+            publish();
+        }
+    }
+
+    void afterTick(const GWInputState& in) {
+        gunsPicked += world.events.gunPicked ? 1 : 0;
+        ghostsShot += (uint64_t)world.events.ghostsShot;
+        caught += world.events.caught ? 1 : 0;
+        if (onTick) onTick(in, world);
+    }
+    void addPhases() {
+        const GWFrameStats& s = prof.current();
+        for (int p = 0; p < GW_PROF_CPU_COUNT; ++p) simMs[p] += s.cpuMs[p];
+    }
+    void publish() {
+        GWSnapshot& s = snaps.writeBuffer();
+        gw_captureSnapshot(world, s);
+        s.gunsPicked = gunsPicked; s.ghostsShot = ghostsShot; s.caught = caught;
+        std::copy(simMs, simMs + GW_PROF_CPU_COUNT, s.simMs);
+        snapTick = world.tick;
+        snaps.publish();
+    }
+
+    GWWorld& world;
+    float dt;
+    GWSimClock clock;               // โหมด inline เท่านั้น
+    GWProfiler prof;                // เวลาเฟสของ step (ของ thread นี้เอง: GWProfiler ไม่ thread-safe)
+    GWTripleBuffer<GWSnapshot> snaps;
+    GWSpscQueue<GWInputState, 256> inputs;
+    glm::ivec2 lastSent{ 0 };
+    std::thread thread;
+    std::atomic<bool> quit{ false };
+    uint64_t snapTick = ~0ull;
+    uint64_t gunsPicked = 0, ghostsShot = 0, caught = 0;
+    double simMs[GW_PROF_CPU_COUNT] = {};
+};
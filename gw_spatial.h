@@ -0,0 +1,84 @@
+// Grid Walk 3D — spatial hash (broadphase)
+// จัด entity ลง bucket ตาม tile ที่อยู่ (key = tile เดียวกับ GWGrid) ด้วย counting sort: build O(n), ไม่ขึ้นกับขนาดแผนที่
+// bucket ชนกันได้ (hash) -> query อาจคืนตัวที่ไม่ได้อยู่ใน tile นั้น, ผู้เรียกต้องทำ narrow-phase เอง
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+struct GWSpatialHash {
+    uint32_t shift = 28;                 // buckets = 1 << (32 - shift)
+    std::vector<uint32_t> cellStart;     // buckets + 1: items[cellStart[b] .. cellStart[b+1]) อยู่ใน bucket b
+    std::vector<uint32_t> items;         // index ของ entity เรียงตาม bucket (ภายใน bucket เรียงตาม index)
+    std::vector<uint32_t> bucketOf;      // scratch: bucket ของแต่ละ entity
+
+    // ผสม x,y แล้วคูณ Fibonacci ใช้บิตบน (บิตล่างของ x*odd ขึ้นกับบิตล่างของ x เท่านั้น -> ชนเยอะถ้า & mask)
+    static uint32_t hashTile(const glm::ivec2& t) {
+        return ((uint32_t)t.x * 73856093u ^ (uint32_t)t.y * 19349663u) * 2654435769u;
+    }
+    uint32_t bucket(const glm::ivec2& t) const { return hashTile(t) >> shift; }
+
+    static uint32_t bucketsFor(size_t n) {
+        uint32_t buckets = 16;
+        while (buckets < n * 2) buckets <<= 1;
+        return buckets;
+    }
+
+    // จองสำหรับ n entity: build ที่ n ไม่เกินนี้ไม่ allocate
+    void reserve(size_t n) {
+        cellStart.reserve(bucketsFor(n) + 1);
+        bucketOf.reserve(n);
+        items.reserve(n);
+    }
+
+    // tileOf(i) -> glm::ivec2 ของ entity i; vectors เก็บ capacity ไว้ จึงไม่ allocate ใหม่ทุก tick
+    template<class TileFn>
+    void build(size_t n, TileFn tileOf) {
+        const uint32_t buckets = bucketsFor(n);
+        shift = 28;
+        for (uint32_t b = 16; b < buckets; b <<= 1) --shift;
+
+        cellStart.assign(buckets + 1, 0);
+        bucketOf.resize(n);
+        items.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t b = bucket(tileOf(i));
+            bucketOf[i] = b;
+            ++cellStart[b + 1];
+        }
+        for (uint32_t b = 0; b < buckets; ++b) cellStart[b + 1] += cellStart[b];
+        // scatter: ใช้ cellStart[b] เป็นตัวนับชั่วคราว แล้วเลื่อนกลับทีหลัง
+        for (size_t i = 0; i < n; ++i) items[cellStart[bucketOf[i]]++] = (uint32_t)i;
+        for (uint32_t b = buckets; b > 0; --b) cellStart[b] = cellStart[b - 1];
+        cellStart[0] = 0;
+    }
+
+    // เรียก fn(index) กับทุก entity ใน bucket ของ tile (รวมตัวที่ hash ชนกัน)
+    template<class Fn>
+    void forTile(const glm::ivec2& t, Fn fn) const {
+        if (items.empty()) return;
+        uint32_t b = bucket(t);
+        for (uint32_t k = cellStart[b]; k < cellStart[b + 1]; ++k) fn(items[k]);
+    }
+
+    // ทุก tile ที่กล่อง [lo, hi] แตะ
+    // (tile ต่างกันอาจ hash ลง bucket เดียวกัน -> fn อาจถูกเรียกซ้ำกับ index เดิม)
+    template<class Fn>
+    void forBox(const glm::vec2& lo, const glm::vec2& hi, Fn fn) const {
+        int x0 = (int)std::floor(lo.x), x1 = (int)std::floor(hi.x);
+        int y0 = (int)std::floor(lo.y), y1 = (int)std::floor(hi.y);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                forTile({ x, y }, fn);
+    }
+
+    // ทุก tile ที่วงกลม (p, r) แตะ: r < 1 -> อย่างมาก 2x2 tile แทนที่จะดู 3x3
+    template<class Fn>
+    void forRadius(const glm::vec2& p, float r, Fn fn) const {
+        forBox(p - glm::vec2(r), p + glm::vec2(r), fn);
+    }
+};
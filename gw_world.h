@@ -0,0 +1,1002 @@
+// Grid Walk 3D — simulation core
+// ไม่มี GL / GLFW: ใช้แค่ glm (header-only) จึง build เป็น library แยกหรือรันบนเครื่องที่ไม่มีจอได้
+// Player movement, ghost chase, bullets and collisions run in fixed ticks through GWWorld::step.
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "gw_grid.h"
+#include "gw_spatial.h"
+#include "gw_jobs.h"
+#include "gw_profiler.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// ---------------- Default map ----------------
+// Input format only: GWGrid::fromText turns it into the packed grid
+static const std::vector<std::string> GW_DEFAULT_MAP = {
+"###############",
+"#K....#.......#",
+"#.###.#.#####.#",
+"#.#...#.....#.#",
+"#.#.#####.#.#.#",
+"#.#.....#...#.#",
+"#.#####.#.#.#.#",
+"#.....#.#.#...#",
+"###.#.#.#.###.#",
+"#P..#.#.......#",
+"#.###.#.#####.#",
+"#.....#.....#.#",
+"#.#####.###.#.#",
+"#.......#..G#.#",
+"###############"
+};
+
+// Speeds
+static const float GW_STEP_SPEED_PLAYER = 6.0f;
+static const float GW_STEP_SPEED_ENEMY = 5.0f;
+static const float GW_BULLET_SPEED = 12.0f;
+static const float GW_FIRE_COOLDOWN = 0.25f;
+static const float GW_BULLET_LIFE = 1.5f;
+// กระสุนของผู้เล่นที่ alive พร้อมกันได้มากสุด (ยิงได้ทุก cooldown, อยู่ได้ life วินาที) = ขนาด pool ตั้งต้น
+static const size_t GW_PLAYER_BULLETS = (size_t)(GW_BULLET_LIFE / GW_FIRE_COOLDOWN) + 1;
+
+// Hit radii (ต้อง < 1 tile: broadphase ดูแค่ 2x2 tile)
+static const float GW_HIT_RADIUS_BULLET = 0.7f;
+static const float GW_HIT_RADIUS_PLAYER = 0.55f;
+
+// Fixed tick
+static const float GW_SIM_DT = 1.0f / 60.0f;
+
+// ขนาดก้อนงานต่อ job (น้อยกว่านี้ไม่คุ้มค่าส่งข้าม thread)
+static const size_t GW_JOB_GRAIN_GHOSTS = 2048;
+static const size_t GW_JOB_GRAIN_BULLETS = 4096;
+
+// ---------------- Entities ----------------
+struct GWMoveCtrl {
+    bool        moving = false;
+    glm::ivec2  dir{ 0,0 };
+    glm::ivec2  queued{ 0,0 };
+    glm::vec2   target{ 0 };
+};
+struct GWEntity {
+    glm::vec2 pos{ 0 };
+    glm::vec2 prevPos{ 0 };   // ตำแหน่งตอนต้น tick สำหรับ interpolate ตอนวาด
+    float     yaw = 0.f;
+    GWMoveCtrl ctrl;
+};
+
+// Ghosts: SoA — แต่ละ field เป็น array ต่อกัน ให้ loop ที่ขยับทุกตัว vectorize ได้
+// index i ของทุก array คือผีตัวเดียวกัน; ลบด้วย swap-and-pop (ลำดับเปลี่ยนได้)
+// pool ขนาดคงที่: reserve ตอน load (GWWorld::reserve) แล้ว spawn/swapRemove ไม่ allocate จนกว่าจะเกิน capacity
+struct GWGhosts {
+    std::vector<float>   x, y;              // pos
+    std::vector<float>   prevX, prevY;      // ตำแหน่งตอนต้น tick
+    std::vector<float>   tx, ty;            // target: ศูนย์กลาง tile ถัดไป
+    std::vector<int8_t>  dirX, dirY;        // ทิศที่กำลังเดิน
+    std::vector<uint8_t> moving;
+    std::vector<float>   yaw;
+
+    template<class F> void forEachArray(F f) {
+        f(x); f(y); f(prevX); f(prevY); f(tx); f(ty); f(dirX); f(dirY); f(moving); f(yaw);
+    }
+
+    size_t size() const { return x.size(); }
+    bool   empty() const { return x.empty(); }
+    void   clear() { forEachArray([](auto& v) { v.clear(); }); }
+    void   reserve(size_t n) { forEachArray([n](auto& v) { v.reserve(n); }); }
+
+    void spawn(const glm::vec2& p) {
+        x.push_back(p.x); y.push_back(p.y);
+        prevX.push_back(p.x); prevY.push_back(p.y);
+        tx.push_back(0.f); ty.push_back(0.f);
+        dirX.push_back(0); dirY.push_back(0);
+        moving.push_back(0);
+        yaw.push_back(0.f);
+    }
+    void swapRemove(size_t i) {
+        forEachArray([i](auto& v) { v[i] = v.back(); v.pop_back(); });
+    }
+
+    glm::vec2  pos(size_t i) const { return { x[i], y[i] }; }
+    glm::vec2  prevPos(size_t i) const { return { prevX[i], prevY[i] }; }
+    glm::ivec2 dir(size_t i) const { return { dirX[i], dirY[i] }; }
+};
+
+// Bullets: SoA + alive mask; slot ที่ตายแล้วถูกเก็บใน freeSlots ให้นัดถัดไปใช้ซ้ำ (ไม่ compact)
+// slot ใหม่ต่อท้ายเฉพาะเมื่อไม่มี slot ว่าง -> จำนวน slot = alive พร้อมกันมากสุด; reserve ไว้ทั้งก้อนตอน load
+struct GWBullets {
+    std::vector<float>    x, y;
+    std::vector<float>    prevX, prevY;
+    std::vector<float>    dirX, dirY;
+    std::vector<float>    life;
+    std::vector<uint8_t>  alive;
+    std::vector<uint32_t> freeSlots;
+    size_t live = 0;                        // จำนวนนัดที่ยัง alive
+
+    size_t slots() const { return x.size(); }
+    void clear() {
+        x.clear(); y.clear(); prevX.clear(); prevY.clear();
+        dirX.clear(); dirY.clear(); life.clear(); alive.clear();
+        freeSlots.clear(); live = 0;
+    }
+    void reserve(size_t n) {
+        x.reserve(n); y.reserve(n); prevX.reserve(n); prevY.reserve(n);
+        dirX.reserve(n); dirY.reserve(n); life.reserve(n); alive.reserve(n);
+        freeSlots.reserve(n);
+    }
+
+    uint32_t spawn(const glm::vec2& p, const glm::vec2& d, float lifeSec) {
+        uint32_t i;
+        if (!freeSlots.empty()) { i = freeSlots.back(); freeSlots.pop_back(); }
+        else {
+            i = (uint32_t)x.size();
+            x.push_back(0); y.push_back(0); prevX.push_back(0); prevY.push_back(0);
+            dirX.push_back(0); dirY.push_back(0); life.push_back(0); alive.push_back(0);
+        }
+        x[i] = prevX[i] = p.x; y[i] = prevY[i] = p.y;
+        dirX[i] = d.x; dirY[i] = d.y;
+        life[i] = lifeSec; alive[i] = 1;
+        ++live;
+        return i;
+    }
+    void kill(uint32_t i) { alive[i] = 0; freeSlots.push_back(i); --live; }
+
+    glm::vec2 pos(size_t i) const { return { x[i], y[i] }; }
+    glm::vec2 prevPos(size_t i) const { return { prevX[i], prevY[i] }; }
+};
+
+static inline glm::vec2 gw_centerOf(const glm::ivec2& t) { return glm::vec2(t) + glm::vec2(0.5f); }
+static inline glm::ivec2 gw_tileOf(const glm::vec2& p) { return { (int)std::floor(p.x), (int)std::floor(p.y) }; }
+
+// ทิศทั้ง 4 (ลำดับเดียวกับ greedy เดิม)
+static const glm::ivec2 GW_DIRS[4] = { {1,0},{-1,0},{0,1},{0,-1} };
+
+// ---------------- Flow field ----------------
+// BFS ครั้งเดียวจาก tile ของผู้เล่น แล้วผีทุกตัวอ่านทิศถัดไปของ tile ตัวเองได้ใน O(1)
+// Rebuilt only when the player changes tile, so cost does not grow with ghost count.
+// แผนที่ไม่เกิน GW_FLOW_FULL_TILES: field ครอบทั้งแผนที่ (1 B/tile + queue 4 B/tile; 1024^2 ~ 5 MB, build ไม่กี่ ms)
+// ใหญ่กว่านั้น: ค้นแค่หน้าต่าง (2 * GW_FLOW_RADIUS + 1)^2 รอบผู้เล่น แล้ว GWChunkFlow พาผีที่อยู่นอกหน้าต่างเข้ามา
+static const size_t GW_FLOW_FULL_TILES = (size_t)1 << 21;     // ~1448^2
+static const int GW_FLOW_RADIUS = 128;
+
+struct GWFlowField {
+    enum : uint8_t {
+        NONE = 0xFF,                      // ไปไม่ถึงผู้เล่น (หรืออยู่นอกหน้าต่าง)
+        GOAL = 0xFE,                      // tile ของผู้เล่นเอง
+        WALL = 0xFD                       // ใน dir เท่านั้น (at() คืน NONE)
+    };
+
+    int radius = 0;                       // 0 = ทั้งแผนที่, ไม่งั้น GW_FLOW_RADIUS (ตั้งใน reserve)
+    int ox = 0, oy = 0;                   // มุมซ้ายบนของหน้าต่าง (tile)
+    int w = 0, h = 0;                     // ขนาดหน้าต่าง
+    glm::ivec2 target{ -1,-1 };
+    std::vector<uint8_t>  dir;            // (w + 2) x (h + 2) มีขอบ WALL รอบหน้าต่าง: index ใน GW_DIRS ที่พาเข้าใกล้ผู้เล่น 1 ก้าว
+    std::vector<uint32_t> queue;          // scratch ของ BFS (ขนาดเท่าหน้าต่างใหญ่สุด ไม่ย่อ)
+    size_t reached = 0;                   // tile ที่ไปถึงผู้เล่นได้ใน build ล่าสุด
+
+    bool valid(const glm::ivec2& t) const {
+        return (unsigned)(t.x - ox) < (unsigned)w && (unsigned)(t.y - oy) < (unsigned)h;
+    }
+    size_t index(const glm::ivec2& t) const { return (size_t)(t.y - oy + 1) * (size_t)(w + 2) + (size_t)(t.x - ox + 1); }
+
+    // เลือกโหมดตามขนาดแผนที่ แล้วจองหน้าต่างใหญ่สุด: build ตอนผู้เล่นเดินไปมาจึงไม่ต้องขยาย dir/queue
+    void reserve(const GWGrid& grid, size_t fullTiles = GW_FLOW_FULL_TILES) {
+        radius = (size_t)grid.w * (size_t)grid.h > fullTiles ? GW_FLOW_RADIUS : 0;
+        const size_t n = radius == 0 ? (size_t)(grid.w + 2) * (size_t)(grid.h + 2)
+            : (size_t)(std::min(grid.w, 2 * radius + 1) + 2) * (size_t)(std::min(grid.h, 2 * radius + 1) + 2);
+        dir.reserve(n);
+        if (queue.size() < n + 4) queue.resize(n + 4);
+    }
+
+    // ผนังถูกเขียนลง dir ก่อน (ทีละ 8 tile จาก GWGrid::rowBits) และขอบหน้าต่างเป็น WALL:
+    // loop ของ BFS จึงเช็คแค่ byte เดียวต่อเพื่อนบ้าน ไม่มีเช็ค bounds / อ่าน grid
+    void build(const GWGrid& grid, const glm::ivec2& goal) {
+        target = goal;
+        if (radius == 0) { ox = 0; oy = 0; w = grid.w; h = grid.h; }
+        else {
+            ox = std::max(0, goal.x - radius); oy = std::max(0, goal.y - radius);
+            w = std::max(0, std::min(grid.w, goal.x + radius + 1) - ox);
+            h = std::max(0, std::min(grid.h, goal.y + radius + 1) - oy);
+        }
+        const int pw = w + 2;
+        dir.assign((size_t)pw * (size_t)(h + 2), (uint8_t)WALL);
+        reached = 0;
+
+        // byte ของ 8 bit ผนัง (bit = 1 -> WALL, 0 -> NONE) ใส่ทีละ uint64
+        static const struct Expand {
+            uint64_t v[256];
+            Expand() {
+                for (int b = 0; b < 256; ++b) {
+                    uint64_t x = 0;
+                    for (int k = 0; k < 8; ++k) x |= (uint64_t)((b >> k) & 1 ? WALL : NONE) << (8 * k);
+                    v[b] = x;     // little-endian: byte k = tile k
+                }
+            }
+        } expand;
+        for (int y = 0; y < h; ++y) {
+            uint8_t* row = dir.data() + (size_t)(y + 1) * pw + 1;
+            for (int x0 = 0; x0 < w; x0 += 64) {
+                const int n = std::min(64, w - x0);
+                const uint64_t bits = grid.rowBits(ox + x0, oy + y, n);
+                int k = 0;
+                for (; k + 8 <= n; k += 8) std::memcpy(row + x0 + k, &expand.v[(bits >> k) & 0xFF], 8);
+                for (; k < n; ++k) row[x0 + k] = (bits >> k) & 1 ? (uint8_t)WALL : (uint8_t)NONE;
+            }
+        }
+        if (!valid(goal)) return;
+        const uint32_t start = (uint32_t)index(goal);
+        if (dir[start] == WALL) return;
+
+        // เพื่อนบ้านแบบไม่มี branch (maze ทำให้ branch เดาผิดบ่อย): เขียนลง queue เสมอ แล้วขยับ tail เฉพาะ tile ใหม่
+        // tile เข้า queue ได้ครั้งเดียว -> queue ไม่เกินจำนวน tile ของหน้าต่าง (+3 ช่องที่เขียนทิ้งท้าย)
+        const int step[4] = { 1, -1, pw, -pw };   // ลำดับเดียวกับ GW_DIRS
+        if (queue.size() < (size_t)w * (size_t)h + 4) queue.resize((size_t)w * (size_t)h + 4);
+        uint8_t* d = dir.data();
+        uint32_t* q = queue.data();
+        size_t tail = 0;
+        d[start] = GOAL;
+        q[tail++] = start;
+        for (size_t head = 0; head < tail; ++head) {
+            const uint32_t c = q[head];
+            for (int k = 0; k < 4; ++k) {
+                const uint32_t n = (uint32_t)((int)c + step[k]);
+                const uint8_t v = d[n];
+                const bool fresh = v == NONE;
+                d[n] = fresh ? (uint8_t)(k ^ 1) : v;   // GW_DIRS[k ^ 1] = ทิศย้อนกลับไปหา cell ที่มาจาก
+                q[tail] = n;
+                tail += fresh;
+            }
+        }
+        reached = tail;
+    }
+
+    uint8_t at(const glm::ivec2& t) const {
+        if (!valid(t)) return NONE;
+        const uint8_t v = dir[index(t)];
+        return v == WALL ? (uint8_t)NONE : v;
+    }
+};
+
+// ---------------- Chunk flow ----------------
+// field หยาบสำหรับแผนที่ที่ GWFlowField เป็นหน้าต่าง: ผีที่ field ละเอียดไม่มีทาง (นอกหน้าต่าง หรือทางออกนอกหน้าต่าง) เดินตามนี้
+// node = กลุ่ม tile ว่างที่เชื่อมกันภายใน chunk C x C หนึ่ง, edge = tile ว่างสองช่องติดกันข้ามขอบ chunk
+// -> ไปถึงกันได้ใน graph เท่ากับไปถึงกันได้จริงในแผนที่ (ผีไม่ติดทางตันแบบ greedy)
+// graph สร้างครั้งเดียวตอน load (อ่านผนังทั้งแผนที่ครั้งเดียว), BFS บน graph ใหม่เมื่อผู้เล่นเปลี่ยน chunk
+// ทิศระดับ tile ใน chunk: BFS จาก tile ขอบที่ข้ามไป node ถัดไปได้ (ทุก node ของ chunk ใน BFS เดียว เพราะไม่เชื่อมกันใน chunk)
+// cache ต่อ chunk แบบ LRU (4 KB ต่อ chunk, จองตามจำนวนผีใน reserve: ผีกระจายทั่วแผนที่ก็ไม่ต้อง build ซ้ำทุก tick)
+// BFS ใหม่ build ใหม่เฉพาะ chunk ที่ next ของ node ใดเปลี่ยน; สร้างบน thread ของ step เท่านั้น (ghost loop ขนานไม่แตะ)
+static const size_t GW_CHUNK_FLOW_CACHE = 256;  // ขั้นต่ำของ cache (chunk)
+
+struct GWChunkFlow {
+    enum { C = 64 };
+    enum : uint16_t { NOLABEL = 0xFFFF };         // ผนัง / นอกแผนที่
+    enum : uint32_t { NONE = 0xFFFFFFFFu };       // ไม่มี node
+
+    int cw = 0, ch = 0;                   // จำนวน chunk (0 = ไม่ได้ใช้)
+    std::vector<uint32_t> first;          // node แรกของ chunk c; node ของ label l = first[c] + l (ขนาด cw*ch + 1)
+    std::vector<uint16_t> border;         // label ของ tile ขอบ: [(c * 4 + side) * C + i], side ตาม GW_DIRS
+    std::vector<uint32_t> edgeFirst, edges;     // adjacency แบบ CSR
+    std::vector<uint32_t> next, prevNext; // node ถัดไปทางผู้เล่น (NONE = ไปไม่ถึง; node ของผู้เล่นชี้ตัวเอง)
+    std::vector<uint32_t> queue;
+    int goalChunk = -1;
+    uint32_t goal = NONE, gen = 1;
+    std::vector<uint32_t> chunkGen;       // gen ล่าสุดที่ next ของ chunk นี้เปลี่ยน: cache ที่ build ก่อนหน้านั้นต้อง build ใหม่
+
+    struct Local { int chunk; uint32_t built; uint64_t used; uint8_t dir[C * C]; };
+    std::vector<Local> locals;
+    std::vector<int32_t> slotOf;          // chunk -> index ใน locals (-1 = ไม่มี)
+    uint64_t clock = 0;
+    std::vector<uint16_t> labels, lq;     // scratch ของ label() (C * C; ว่างถ้าไม่ได้ใช้ จึงไม่เพิ่มขนาด world เล็กๆ)
+
+    bool active() const { return cw > 0; }
+
+    // label component ของ chunk (cx, cy) ลง labels (ผนัง/นอกแผนที่ = NOLABEL); คืนจำนวน component
+    int label(const GWGrid& g, int cx, int cy) {
+        uint64_t open[C];
+        for (int r = 0; r < C; ++r) open[r] = ~g.rowBits(cx * C, cy * C + r, C);
+        std::fill(labels.begin(), labels.end(), NOLABEL);
+        int count = 0;
+        for (int i = 0; i < C * C; ++i) {
+            if (labels[i] != NOLABEL || !((open[i / C] >> (i % C)) & 1)) continue;
+            int qn = 0;
+            labels[i] = (uint16_t)count; lq[qn++] = (uint16_t)i;
+            for (int head = 0; head < qn; ++head) {
+                const int x = lq[head] % C, y = lq[head] / C;
+                for (int k = 0; k < 4; ++k) {
+                    const int nx = x + GW_DIRS[k].x, ny = y + GW_DIRS[k].y;
+                    if ((unsigned)nx >= (unsigned)C || (unsigned)ny >= (unsigned)C) continue;
+                    const int n = ny * C + nx;
+                    if (labels[n] != NOLABEL || !((open[ny] >> nx) & 1)) continue;
+                    labels[n] = (uint16_t)count; lq[qn++] = (uint16_t)n;
+                }
+            }
+            ++count;
+        }
+        return count;
+    }
+    static int borderTile(int side, int i) {     // tile ที่ i บนขอบ side (ขวา ซ้าย ล่าง บน)
+        switch (side) { case 0: return i * C + C - 1; case 1: return i * C; case 2: return (C - 1) * C + i; default: return i; }
+    }
+    int neighbor(int c, int side) const {
+        const int cx = c % cw + GW_DIRS[side].x, cy = c / cw + GW_DIRS[side].y;
+        return cx < 0 || cy < 0 || cx >= cw || cy >= ch ? -1 : cy * cw + cx;
+    }
+
+    void build(const GWGrid& g) {
+        cw = (g.w + C - 1) / C; ch = (g.h + C - 1) / C;
+        const int n = cw * ch;
+        labels.assign(C * C, NOLABEL);
+        lq.assign(C * C, 0);
+        first.assign((size_t)n + 1, 0);
+        border.assign((size_t)n * 4 * C, NOLABEL);
+        for (int c = 0; c < n; ++c) {
+            first[c + 1] = first[c] + (uint32_t)label(g, c % cw, c / cw);
+            for (int s = 0; s < 4; ++s)
+                for (int i = 0; i < C; ++i) border[((size_t)c * 4 + s) * C + i] = labels[borderTile(s, i)];
+        }
+        // edge ข้ามขอบขวา/ล่าง (ทั้งสองทิศ) แล้วเรียง + ตัดซ้ำเป็น CSR
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (int c = 0; c < n; ++c)
+            for (int s = 0; s < 4; s += 2) {
+                const int nb = neighbor(c, s);
+                if (nb < 0) continue;
+                for (int i = 0; i < C; ++i) {
+                    const uint16_t a = border[((size_t)c * 4 + s) * C + i], b = border[((size_t)nb * 4 + (s ^ 1)) * C + i];
+                    if (a == NOLABEL || b == NOLABEL) continue;
+                    pairs.push_back({ first[c] + a, first[nb] + b });
+                    pairs.push_back({ first[nb] + b, first[c] + a });
+                }
+            }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        const uint32_t nodes = first[n];
+        edgeFirst.assign((size_t)nodes + 1, 0);
+        for (const auto& e : pairs) ++edgeFirst[e.first + 1];
+        for (uint32_t i = 0; i < nodes; ++i) edgeFirst[i + 1] += edgeFirst[i];
+        edges.resize(pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) edges[i] = pairs[i].second;
+        next.assign(nodes, NONE);
+        prevNext.assign(nodes, NONE);
+        queue.reserve(nodes);
+        gen = 1;
+        chunkGen.assign((size_t)n, gen);
+        locals.clear();
+        slotOf.assign((size_t)n, -1);
+        reserve(0);
+        goalChunk = -1; goal = NONE;
+    }
+    // chunk ที่มีผีพร้อมกันได้มากสุด ~ จำนวนผี (ไม่เกินจำนวน chunk); ไม่ลด capacity
+    void reserve(size_t maxGhosts) {
+        if (active()) locals.reserve(std::min((size_t)cw * ch, std::max(GW_CHUNK_FLOW_CACHE, maxGhosts)));
+    }
+    void clear() { *this = GWChunkFlow(); }
+
+    // BFS บน graph จาก node ของผู้เล่น (เฉพาะตอนเปลี่ยน chunk: ใน chunk เดียวกันผู้เล่นอยู่ node เดิมเสมอ)
+    void update(const GWGrid& g, const glm::ivec2& playerTile) {
+        const int pcx = playerTile.x / C, pcy = playerTile.y / C;
+        if (!g.inside(playerTile.x, playerTile.y)) return;
+        const int pc = pcy * cw + pcx;
+        if (pc == goalChunk) return;
+        goalChunk = pc;
+        label(g, pcx, pcy);
+        const uint16_t l = labels[(playerTile.y % C) * C + playerTile.x % C];
+        const uint32_t node = l == NOLABEL ? NONE : first[pc] + l;
+        if (node == goal) return;
+        goal = node; ++gen;
+        next.swap(prevNext);
+        std::fill(next.begin(), next.end(), NONE);
+        if (goal != NONE) {
+            queue.clear();
+            next[goal] = goal;
+            queue.push_back(goal);
+            for (size_t head = 0; head < queue.size(); ++head) {
+                const uint32_t u = queue[head];
+                for (uint32_t e = edgeFirst[u]; e < edgeFirst[u + 1]; ++e) {
+                    const uint32_t v = edges[e];
+                    if (next[v] != NONE) continue;
+                    next[v] = u;
+                    queue.push_back(v);
+                }
+            }
+        }
+        for (size_t c = 0; c < chunkGen.size(); ++c)
+            for (uint32_t v = first[c]; v < first[c + 1]; ++v)
+                if (next[v] != prevNext[v]) { chunkGen[c] = gen; break; }
+    }
+
+    // ทิศ (index ใน GW_DIRS) ของ tile t ไปยัง node ถัดไป, หรือ GWFlowField::NONE
+    uint8_t at(const GWGrid& g, const glm::ivec2& t) {
+        if (!g.inside(t.x, t.y)) return GWFlowField::NONE;
+        const int c = (t.y / C) * cw + t.x / C;
+        return local(g, c).dir[(t.y % C) * C + t.x % C];
+    }
+
+    Local& local(const GWGrid& g, int c) {
+        int32_t slot = slotOf[c];
+        if (slot < 0) {
+            if (locals.size() < locals.capacity()) { slot = (int32_t)locals.size(); locals.emplace_back(); }
+            else {
+                slot = 0;           // เต็ม: แทนที่อันที่ไม่ได้ใช้นานสุด
+                for (int32_t i = 1; i < (int32_t)locals.size(); ++i)
+                    if (locals[i].used < locals[slot].used) slot = i;
+                slotOf[locals[slot].chunk] = -1;
+            }
+            slotOf[c] = slot;
+            locals[slot].chunk = c;
+            locals[slot].built = 0;
+        }
+        Local& L = locals[slot];
+        L.used = ++clock;
+        if (L.built >= chunkGen[c]) return L;
+        L.built = gen;
+
+        // seed = tile ขอบที่ข้ามไปแล้วอยู่ใน node ถัดไปของ node ตัวเอง; ทิศของ seed = ข้ามขอบ
+        label(g, c % cw, c / cw);
+        std::fill(L.dir, L.dir + C * C, (uint8_t)GWFlowField::NONE);
+        int qn = 0;
+        for (int s = 0; s < 4; ++s) {
+            const int nb = neighbor(c, s);
+            if (nb < 0) continue;
+            for (int i = 0; i < C; ++i) {
+                const int t = borderTile(s, i);
+                const uint16_t a = labels[t], b = border[((size_t)nb * 4 + (s ^ 1)) * C + i];
+                if (a == NOLABEL || b == NOLABEL || L.dir[t] != GWFlowField::NONE) continue;
+                const uint32_t to = next[first[c] + a];
+                if (to == NONE || to == first[c] + a || to != first[nb] + b) continue;
+                L.dir[t] = (uint8_t)s;
+                lq[qn++] = (uint16_t)t;
+            }
+        }
+        for (int head = 0; head < qn; ++head) {
+            const int x = lq[head] % C, y = lq[head] / C;
+            for (int k = 0; k < 4; ++k) {
+                const int nx = x + GW_DIRS[k].x, ny = y + GW_DIRS[k].y;
+                if ((unsigned)nx >= (unsigned)C || (unsigned)ny >= (unsigned)C) continue;
+                const int n = ny * C + nx;
+                if (labels[n] == NOLABEL || L.dir[n] != GWFlowField::NONE) continue;
+                L.dir[n] = (uint8_t)(k ^ 1);
+                lq[qn++] = (uint16_t)n;
+            }
+        }
+        return L;
+    }
+};
+
+// ---------------- Input / events ----------------
+// Input for one tick: held direction (0,0 = none) and a fire press edge
+struct GWInputState {
+    glm::ivec2 dir{ 0,0 };
+    bool       fire = false;
+};
+
+// สิ่งที่เกิดขึ้นใน tick (ให้ฝั่ง app พิมพ์ข้อความ/เล่นเสียงเอง)
+struct GWEvents {
+    bool gunPicked = false;
+    int  ghostsShot = 0;
+    bool caught = false;
+
+    void merge(const GWEvents& o) {
+        gunPicked = gunPicked || o.gunPicked;
+        ghostsShot += o.ghostsShot;
+        caught = caught || o.caught;
+    }
+};
+
+// ---------------- World ----------------
+struct GWWorld {
+    // แผนที่: grid ไม่เปลี่ยนระหว่างเล่น, keyTaken = ปืนที่ถูกเก็บไปแล้ว (ตาม grid.keys)
+    // keyLog = undo log ของ keyTaken ตั้งแต่ reset ล่าสุด: reset คืนเฉพาะช่องที่เปลี่ยน ไม่ไล่ทั้งตาราง
+    GWGrid   grid;
+    std::vector<uint8_t> keyTaken;
+    std::vector<uint32_t> keyLog;
+    uint32_t mapRev = 0;        // เพิ่มทุกครั้งที่ layout เปลี่ยน (renderer ใช้ตัดสินว่าต้อง build ใหม่)
+
+    GWEntity player;
+    glm::vec2 playerSpawn{ 0 };
+    GWGhosts  ghosts;
+    GWBullets bullets;
+    bool  hasGun = false;
+    float fireCooldown = 0.0f;
+
+    GWFlowField flow;           // ทางไปหาผู้เล่น (แชร์กันทุกผี)
+    GWChunkFlow chunkFlow;      // ทางหยาบสำหรับผีนอกหน้าต่างของ flow (เฉพาะแผนที่ใหญ่กว่า flowFullTiles)
+    size_t flowFullTiles = GW_FLOW_FULL_TILES;  // ตั้งก่อน load (check ใช้บังคับโหมดหน้าต่างบนแผนที่เล็ก)
+    GWSpatialHash ghostHash;    // broadphase ของผี, build ใหม่ทุก tick หลังผีขยับ
+    std::vector<uint32_t> ghostKills;   // scratch: index ผีที่โดนยิงใน tick นี้
+    std::vector<uint8_t>  ghostDead;    // scratch: mark ตาม index (ก่อนลบจริง)
+    std::vector<uint8_t>  bulletDead;   // scratch: หมดอายุ/ชนผนังใน tick นี้ (kill หลังเช็คผีแล้ว ตามลำดับ slot)
+    std::vector<uint32_t> bulletHit;    // scratch: ผีที่แต่ละนัดแตะก่อน (ก่อน merge)
+
+    GWJobSystem* jobs = nullptr;        // ไม่ได้เป็นเจ้าของ; nullptr = รันทุกอย่างบน thread เดียว
+    GWProfiler*  prof = nullptr;        // ไม่ได้เป็นเจ้าของ; nullptr = ไม่จับเวลาเฟส
+
+    uint64_t tick = 0;
+    GWEvents events;            // ของ tick ล่าสุด
+
+    void load(const std::vector<std::string>& text) { load(GWGrid::fromText(text)); }
+    void load(GWGrid g);
+    void reserve(size_t maxGhosts, size_t maxBullets);
+    void reset();
+    void step(float dt, const GWInputState& in);
+
+    bool wallAt(int x, int y) const { return grid.wallChecked(x, y); }
+};
+
+// Enemy greedy steering (fallback เมื่อทั้ง flow field และ chunk flow ไปไม่ถึงผู้เล่น)
+static inline glm::ivec2 gw_chooseDirGreedy(const GWWorld& w, const glm::ivec2& fromTile, const glm::ivec2& curDir, const glm::ivec2& playerTile) {
+    glm::ivec2 best = curDir; int bestScore = 1e9;
+    for (const auto& d : GW_DIRS) {
+        if (d == -curDir) continue;
+        glm::ivec2 nt = fromTile + d;
+        if (w.grid.wall(nt.x, nt.y)) continue;
+        int s = std::abs(playerTile.x - nt.x) + std::abs(playerTile.y - nt.y);
+        if (s < bestScore) { bestScore = s; best = d; }
+    }
+    if (bestScore == 1e9) {
+        glm::ivec2 rev = -curDir;
+        if (!w.grid.wall(fromTile.x + rev.x, fromTile.y + rev.y)) return rev;
+        return { 0,0 };
+    }
+    return best;
+}
+
+// Enemy steering: follow the shared flow field, greedy only if the player is unreachable
+static inline glm::ivec2 gw_chooseDirChase(const GWWorld& w, const glm::ivec2& fromTile, const glm::ivec2& curDir, const glm::ivec2& playerTile) {
+    uint8_t k = w.flow.at(fromTile);
+    if (k < 4) return GW_DIRS[k];
+    if (k == GWFlowField::GOAL) return { 0,0 };  // อยู่ tile เดียวกับผู้เล่นแล้ว
+    return gw_chooseDirGreedy(w, fromTile, curDir, playerTile);
+}
+
+static inline float gw_yawOf(const glm::ivec2& d, float cur) {
+    if (d == glm::ivec2(1, 0))       return 0.f;
+    else if (d == glm::ivec2(-1, 0)) return 180.f;
+    else if (d == glm::ivec2(0, 1))  return 90.f;
+    else if (d == glm::ivec2(0, -1)) return -90.f;
+    return cur;
+}
+
+// สิ่งที่ขึ้นกับขนาดแผนที่ทำครั้งเดียวที่นี่: key index (ถ้า grid ยังไม่มี), ตาราง keyTaken, จุดเกิดผู้เล่น, ล้าง flow field, จอง pool/scratch
+inline void GWWorld::load(GWGrid g) {
+    grid = std::move(g);
+    ++mapRev;
+    grid.indexKeys();
+    keyTaken.assign(grid.keys.size(), 0);
+    keyLog.clear();
+    keyLog.reserve(grid.keys.size());
+    flow.target = { -1,-1 };    // layout เปลี่ยน: บังคับ build ใหม่
+    flow.reserve(grid, flowFullTiles);
+    if (flow.radius > 0) chunkFlow.build(grid);
+    else chunkFlow.clear();
+    reserve(std::max<size_t>(grid.ghostSpawns.size(), 1), GW_PLAYER_BULLETS);
+    playerSpawn = glm::vec2(0);
+    if (!grid.playerSpawns.empty()) playerSpawn = gw_centerOf(grid.playerSpawns.back());
+    reset();
+}
+
+// จอง pool ของผี/กระสุน + scratch ทุกตัวที่ step ใช้ ให้ tick ที่ไม่เกินจำนวนนี้ไม่ allocate เลย
+// (load เรียกด้วยจำนวนของแผนที่เอง; งานที่เติมผี/กระสุนเพิ่ม เช่น benchmark เรียกซ้ำด้วยยอดของตัวเอง; ไม่ลด capacity)
+inline void GWWorld::reserve(size_t maxGhosts, size_t maxBullets) {
+    ghosts.reserve(maxGhosts);
+    chunkFlow.reserve(maxGhosts);
+    ghostKills.reserve(maxGhosts);
+    ghostDead.reserve(maxGhosts);
+    ghostHash.reserve(maxGhosts);
+    bullets.reserve(maxBullets);
+    bulletDead.reserve(maxBullets);
+    bulletHit.reserve(maxBullets);
+}
+
+// ---------- Reset whole game state ----------
+// O(ปืนที่เก็บไป + จุดเกิดผี) ไม่ขึ้นกับขนาดแผนที่; pool ของผี/กระสุนคง capacity เดิม
+// flow field ยังใช้ได้ (grid ไม่เปลี่ยน): build ใหม่เองเมื่อผู้เล่นอยู่คนละ tile กับ target
+inline void GWWorld::reset() {
+    // ปืนกลับมาเฉพาะกระบอกที่ถูกเก็บ
+    for (uint32_t i : keyLog) keyTaken[i] = 0;
+    keyLog.clear();
+
+    // ล้างสถานะ
+    ghosts.clear();
+    bullets.clear();
+    hasGun = false;
+    fireCooldown = 0.0f;
+    player = GWEntity{}; // reset movement/yaw
+    player.pos = player.prevPos = playerSpawn;
+
+    for (const auto& t : grid.ghostSpawns) ghosts.spawn(gw_centerOf(t));
+    if (ghosts.empty()) ghosts.spawn({ grid.w - 2.5f, grid.h - 2.5f });
+}
+
+// Player movement (tile-by-tile) + pre-turn + gun pickup
+static inline void gw_stepPlayer(GWWorld& w, float dt, const GWInputState& in) {
+    GWEntity& player = w.player;
+    if (in.dir != glm::ivec2(0)) player.ctrl.queued = in.dir;
+
+    auto apply_dir = [&](const glm::ivec2& d) {
+        player.ctrl.dir = d;
+        player.yaw = gw_yawOf(d, player.yaw);
+        };
+
+    if (!player.ctrl.moving && player.ctrl.queued != glm::ivec2(0)) {
+        glm::ivec2 t = gw_tileOf(player.pos);
+        glm::ivec2 nt = t + player.ctrl.queued;
+        if (!w.grid.wall(nt.x, nt.y)) {
+            apply_dir(player.ctrl.queued);
+            player.ctrl.target = gw_centerOf(nt);
+            player.ctrl.moving = true;
+        }
+    }
+
+    if (player.ctrl.moving && player.ctrl.queued != glm::ivec2(0) && player.ctrl.queued != player.ctrl.dir) {
+        bool orthogonal = (player.ctrl.queued.x == 0 && player.ctrl.dir.x != 0) ||
+            (player.ctrl.queued.y == 0 && player.ctrl.dir.y != 0);
+        if (orthogonal) {
+            glm::ivec2 t = gw_tileOf(player.pos);
+            glm::vec2  center = gw_centerOf(t);
+
+            glm::ivec2 turnTo = t + player.ctrl.queued;
+            if (!w.grid.wall(turnTo.x, turnTo.y)) {
+                const float TURN_SNAP = 0.20f;
+                glm::vec2  toC = center - player.pos;
+                float      distC = glm::length(toC);
+
+                float step = GW_STEP_SPEED_PLAYER * dt;
+                bool willCrossCenter = (distC <= step + 1e-4f);
+
+                if (distC <= TURN_SNAP || willCrossCenter) {
+                    player.pos = center;
+                    apply_dir(player.ctrl.queued);
+                    player.ctrl.target = gw_centerOf(turnTo);
+                    player.ctrl.moving = true;
+                }
+            }
+        }
+    }
+
+    if (player.ctrl.moving) {
+        glm::vec2 to = player.ctrl.target - player.pos;
+        float dist = glm::length(to);
+        if (dist < 1e-4f) {
+            player.pos = player.ctrl.target;
+            player.ctrl.moving = false;
+        }
+        else {
+            glm::vec2 v = (to / std::max(dist, 1e-6f)) * GW_STEP_SPEED_PLAYER;
+            float step = GW_STEP_SPEED_PLAYER * dt;
+            if (step >= dist) { player.pos = player.ctrl.target; player.ctrl.moving = false; }
+            else player.pos += v * dt;
+        }
+    }
+
+    // gun pickup: key บน tile ของผู้เล่นจาก index (ไม่ไล่ตารางปืนทั้งแผนที่ทุก tick)
+    glm::ivec2 pt = gw_tileOf(player.pos);
+    for (uint32_t i : w.grid.keysIn(pt.y, pt.x, pt.x + 1)) {
+        if (w.keyTaken[i]) continue;
+        w.hasGun = true; w.keyTaken[i] = 1; w.keyLog.push_back(i); w.events.gunPicked = true;
+    }
+}
+
+// Shooting (in.fire = กดปุ่มใน tick นี้)
+static inline void gw_stepShoot(GWWorld& w, const GWInputState& in) {
+    if (!in.fire || !w.hasGun || w.fireCooldown > 0.0f) return;
+    const GWEntity& player = w.player;
+    glm::vec2 shootDir(0, -1);
+    if (player.ctrl.dir != glm::ivec2(0)) shootDir = glm::vec2((float)player.ctrl.dir.x, (float)player.ctrl.dir.y);
+    else {
+        if (std::fabs(player.yaw - 0.f) < 1e-3f)        shootDir = { 1, 0 };
+        else if (std::fabs(player.yaw - 180.f) < 1e-1f) shootDir = { -1, 0 };
+        else if (std::fabs(player.yaw - 90.f) < 1e-1f)  shootDir = { 0, 1 };
+        else if (std::fabs(player.yaw + 90.f) < 1e-1f)  shootDir = { 0,-1 };
+    }
+    if (glm::length(shootDir) > 0.0f) {
+        w.bullets.spawn(player.pos, glm::normalize(shootDir), GW_BULLET_LIFE);
+        w.fireCooldown = GW_FIRE_COOLDOWN;
+    }
+}
+
+// เลือก a (mask = ~0) หรือ b (mask = 0) ด้วย bit op: ไม่มี branch และไม่ทำให้ compiler ย้ายการคำนวณ b ไปไว้ใต้เงื่อนไข
+static inline float gw_selectf(uint32_t mask, float a, float b) {
+    uint32_t ia, ib;
+    std::memcpy(&ia, &a, 4); std::memcpy(&ib, &b, 4);
+    uint32_t r = (ia & mask) | (ib & ~mask);
+    float f; std::memcpy(&f, &r, 4);
+    return f;
+}
+
+// Move-toward-target kernel: ไม่มี branch ต่อตัว ให้ compiler ทำเป็น SSE/AVX ได้ (-O3)
+// ผีเดินตามแกนเสมอ (target = ศูนย์กลาง tile ข้างๆ): dist = |dx| + |dy| และ to/dist = sign(to)
+// จึงได้ค่าเท่ากับ glm::length / หาร แบบเดิมทุก bit โดยไม่มี sqrt / div
+static inline void gw_kernelMoveToward(size_t n, float* __restrict x, float* __restrict y,
+    const float* __restrict tx, const float* __restrict ty, uint8_t* __restrict moving, float speed, float dt) {
+    const float step = speed * dt;
+    for (size_t i = 0; i < n; ++i) {
+        const float px = x[i], py = y[i], gx = tx[i], gy = ty[i];
+        const float toX = gx - px, toY = gy - py;
+        const float dist = std::fabs(toX) + std::fabs(toY);
+        const int   mv = moving[i];
+        const int   arrive = mv & ((int)(dist < 1e-4f) | (int)(step >= dist));
+        const int   go = mv & (arrive ^ 1);
+        // sign * go เป็น int ก่อน: ตัวที่ไม่เดินได้ +0 (ไม่มี FP ใต้เงื่อนไข)
+        const float sx = (float)(((int)(toX > 0.0f) - (int)(toX < 0.0f)) * go);
+        const float sy = (float)(((int)(toY > 0.0f) - (int)(toY < 0.0f)) * go);
+        const uint32_t m = 0u - (uint32_t)arrive;
+        x[i] = gw_selectf(m, gx, px + (sx * speed) * dt);
+        y[i] = gw_selectf(m, gy, py + (sy * speed) * dt);
+        moving[i] = (uint8_t)go;
+    }
+}
+
+// Bullet advance kernel: ขยับ + ลด life ทุก slot (slot ที่ตายแล้วไม่สนค่า) — ไม่มี branch
+static inline void gw_kernelAdvance(size_t n, float* __restrict x, float* __restrict y,
+    const float* __restrict dirX, const float* __restrict dirY, float* __restrict life, float speed, float dt) {
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += (dirX[i] * speed) * dt;
+        y[i] += (dirY[i] * speed) * dt;
+        life[i] -= dt;
+    }
+}
+
+// แบ่ง [0, n) เป็นก้อนให้ job system; ทุกก้อนเขียนเฉพาะ slot ในช่วงของตัวเอง ผลจึงเท่ากับรันทีละตัว
+template<class F>
+static inline void gw_parallelFor(const GWWorld& w, size_t n, size_t grain, const F& fn) {
+    if (w.jobs) w.jobs->parallelFor(n, grain, fn);
+    else if (n) fn((size_t)0, n);
+}
+
+static inline void gw_ghostStartMove(GWGhosts& g, size_t i, const glm::ivec2& gt, const glm::ivec2& ndir) {
+    glm::vec2 t = gw_centerOf(gt + ndir);
+    g.dirX[i] = (int8_t)ndir.x; g.dirY[i] = (int8_t)ndir.y;
+    g.tx[i] = t.x; g.ty[i] = t.y;
+    g.moving[i] = 1;
+    g.yaw[i] = gw_yawOf(ndir, g.yaw[i]);
+}
+
+// Ghosts: ตัดสินใจทิศเฉพาะตัวที่หยุดอยู่ (branchy, อ่าน flow field) แล้วขยับทุกตัวด้วย kernel
+// ผีแต่ละตัวไม่ขึ้นกับตัวอื่น (อ่าน flow/grid ร่วมกันอย่างเดียว) จึงแบ่งก้อนขนานได้ตรงๆ
+// แผนที่ใหญ่: ผีที่ field ละเอียดไม่มีทางเลือกทิศจาก chunk flow ก่อน บน thread นี้ (cache ของ chunk flow ไม่ thread-safe)
+static inline void gw_stepGhosts(GWWorld& w, float dt) {
+    glm::ivec2 playerTile = gw_tileOf(w.player.pos);
+    if (playerTile != w.flow.target)        // load ตั้ง target = (-1,-1) เพื่อบังคับ build ใหม่
+        w.flow.build(w.grid, playerTile);
+
+    GWGhosts& g = w.ghosts;
+    if (w.chunkFlow.active()) {
+        w.chunkFlow.update(w.grid, playerTile);
+        for (size_t i = 0; i < g.size(); ++i) {
+            if (g.moving[i]) continue;
+            glm::ivec2 gt = gw_tileOf(g.pos(i));
+            if (w.flow.at(gt) != GWFlowField::NONE) continue;
+            uint8_t k = w.chunkFlow.at(w.grid, gt);
+            if (k < 4) gw_ghostStartMove(g, i, gt, GW_DIRS[k]);
+        }
+    }
+    gw_parallelFor(w, g.size(), GW_JOB_GRAIN_GHOSTS, [&w, &g, playerTile, dt](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            if (g.moving[i]) continue;
+            glm::ivec2 gt = gw_tileOf(g.pos(i));
+            glm::ivec2 ndir = gw_chooseDirChase(w, gt, g.dir(i), playerTile);
+            if (ndir != glm::ivec2(0)) gw_ghostStartMove(g, i, gt, ndir);
+        }
+        gw_kernelMoveToward(e - b, g.x.data() + b, g.y.data() + b, g.tx.data() + b, g.ty.data() + b,
+            g.moving.data() + b, GW_STEP_SPEED_ENEMY, dt);
+    });
+}
+
+// Bullets update: advance ด้วย kernel แล้ว sweep เส้นทางของ tick นี้ (prev -> pos) ผ่าน grid ด้วย DDA
+// ชนผนัง -> ตัดปลายเส้นไว้ที่จุดเข้าผนัง (ผีหลังผนังจึงไม่โดน) และ mark ลง bulletDead พร้อมนัดที่หมดอายุ
+// ยังไม่ kill: นัดที่จบใน tick นี้ยังชนผีระหว่างทางได้ (gw_collideBullets kill ตามลำดับ slot)
+// ไม่ว่า tick ยาวแค่ไหนก็ไม่ทะลุผนัง (เดิมเช็คแค่ tile ปลายทาง: ที่ 10 Hz กระสุนข้ามผนังหนา 1 tile ได้)
+static inline void gw_stepBullets(GWWorld& w, float dt) {
+    GWBullets& b = w.bullets;
+    if (b.live == 0) return;
+    const size_t n = b.slots();
+    w.bulletDead.assign(n, 0);
+    gw_parallelFor(w, n, GW_JOB_GRAIN_BULLETS, [&w, &b, dt](size_t lo, size_t hi) {
+        gw_kernelAdvance(hi - lo, b.x.data() + lo, b.y.data() + lo, b.dirX.data() + lo, b.dirY.data() + lo,
+            b.life.data() + lo, GW_BULLET_SPEED, dt);
+        for (size_t i = lo; i < hi; ++i) {
+            if (!b.alive[i]) continue;
+            float t;
+            const bool wall = w.grid.raycast(b.prevPos(i), b.pos(i), t);
+            if (wall) {
+                b.x[i] = b.prevX[i] + (b.x[i] - b.prevX[i]) * t;
+                b.y[i] = b.prevY[i] + (b.y[i] - b.prevY[i]) * t;
+            }
+            w.bulletDead[i] = (uint8_t)(b.life[i] <= 0.0f || wall);
+        }
+    });
+}
+
+// เวลาแรก t (0..1) ที่ |r0 + (r1 - r0) t|^2 < R2: r0/r1 = ตำแหน่งกระสุนเทียบผีตอนต้น/ปลาย tick
+// (ทั้งคู่เดินเส้นตรงใน tick -> segment vs circle ในกรอบของผี); ไม่แตะ = 2
+static inline float gw_sweptContact(const glm::vec2& r0, const glm::vec2& r1, float R2) {
+    const float c = glm::dot(r0, r0) - R2;
+    if (c < 0.0f) return 0.0f;
+    const glm::vec2 d = r1 - r0;
+    const float a = glm::dot(d, d), bh = glm::dot(r0, d);
+    if (a <= 0.0f || bh >= 0.0f) return 2.0f;          // อยู่นิ่งเทียบกัน หรือกำลังห่างออก
+    const float disc = bh * bh - a * c;
+    if (disc < 0.0f) return 2.0f;
+    const float t = (-bh - std::sqrt(disc)) / a;
+    return t <= 1.0f ? t : 2.0f;
+}
+
+// Bullet vs Ghost: segment ของกระสุนใน tick นี้ เทียบกับผีที่ขยับไปพร้อมกัน (จาก ghostHash)
+// broadphase = กล่องรอบ segment ขยายด้วยรัศมี + ระยะที่ผีเดินได้ใน tick (hash ใช้ตำแหน่งปลาย tick ของผี)
+// กฎ: ไล่กระสุนตามลำดับ slot, แต่ละนัดฆ่าผีที่ยังไม่ตายซึ่งแตะก่อน (t น้อยสุด, เท่ากัน -> index ต่ำสุด) ได้ตัวเดียว
+// ขั้นขนาน: หาเป้าของทุกนัด (ไม่สนว่าผีตายหรือยัง)
+// ขั้น merge (ตามลำดับ): ถ้าตัวนั้นถูกนัดก่อนหน้าเอาไปแล้ว ค่อย query ใหม่แบบข้ามตัวที่ตาย -> ผลเท่ากับรันทีละนัด
+static inline uint32_t gw_bulletTarget(const GWWorld& w, uint32_t i, bool skipDead, float ghostStep) {
+    const float R2 = GW_HIT_RADIUS_BULLET * GW_HIT_RADIUS_BULLET;
+    const GWGhosts& g = w.ghosts;
+    const glm::vec2 b0 = w.bullets.prevPos(i), b1 = w.bullets.pos(i);
+    const glm::vec2 pad(GW_HIT_RADIUS_BULLET + ghostStep);
+    uint32_t hit = UINT32_MAX;
+    float first = 2.0f;
+    w.ghostHash.forBox(glm::min(b0, b1) - pad, glm::max(b0, b1) + pad, [&](uint32_t gi) {
+        if (skipDead && w.ghostDead[gi]) return;
+        const float t = gw_sweptContact(b0 - g.prevPos(gi), b1 - g.pos(gi), R2);
+        if (t < first || (t == first && t <= 1.0f && gi < hit)) { first = t; hit = gi; }
+    });
+    return hit;
+}
+
+static inline void gw_collideBullets(GWWorld& w, float dt) {
+    GWBullets& b = w.bullets;
+    const size_t n = b.slots();
+    const float ghostStep = GW_STEP_SPEED_ENEMY * dt;
+    w.bulletHit.resize(n);
+    w.bulletDead.resize(n, 0);      // เรียกตรงโดยไม่ผ่าน gw_stepBullets (headless --collision-bench)
+    gw_parallelFor(w, n, GW_JOB_GRAIN_BULLETS, [&w, &b, ghostStep](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i)
+            w.bulletHit[i] = b.alive[i] ? gw_bulletTarget(w, (uint32_t)i, false, ghostStep) : UINT32_MAX;
+    });
+
+    for (uint32_t i = 0; i < (uint32_t)n; ++i) {
+        uint32_t hit = w.bulletHit[i];
+        if (hit != UINT32_MAX && w.ghostDead[hit]) hit = gw_bulletTarget(w, i, true, ghostStep);
+        if (hit == UINT32_MAX) {
+            if (w.bulletDead[i]) b.kill(i);     // หมดอายุ/ชนผนังโดยไม่โดนผีระหว่างทาง
+            continue;
+        }
+        b.kill(i);
+        w.ghostDead[hit] = 1;
+        w.ghostKills.push_back(hit);
+    }
+}
+
+// Player vs Ghost (ข้ามผีที่เพิ่งโดนยิง); ไม่มี hash (ไม่มีกระสุน) -> scan ตรงๆ ซึ่งถูกกว่า build
+static inline bool gw_playerCaught(const GWWorld& w, bool hashed) {
+    const float R2 = GW_HIT_RADIUS_PLAYER * GW_HIT_RADIUS_PLAYER;
+    const GWGhosts& g = w.ghosts;
+    const float px = w.player.pos.x, py = w.player.pos.y;
+    if (!hashed) {
+        // reduction แบบไม่มี early-out: vectorize ได้
+        const size_t n = g.size();
+        int hits = 0;
+        for (size_t i = 0; i < n; ++i) {
+            float dx = g.x[i] - px, dy = g.y[i] - py;
+            hits += (dx * dx + dy * dy < R2) ? 1 : 0;
+        }
+        return hits > 0;
+    }
+    bool caught = false;
+    w.ghostHash.forRadius(w.player.pos, GW_HIT_RADIUS_PLAYER, [&](uint32_t gi) {
+        if (w.ghostDead[gi]) return;
+        float dx = g.x[gi] - px, dy = g.y[gi] - py;
+        if (dx * dx + dy * dy < R2) caught = true;
+    });
+    return caught;
+}
+
+// ลบผีที่ตายทั้งหมดทีเดียวด้วย swap-and-pop, จาก index มากไปน้อย
+// (ตัวที่ย้ายมาจากท้ายจึงไม่ใช่ตัวที่ต้องลบ; ลำดับผีเปลี่ยนแต่ยัง deterministic)
+static inline void gw_removeKilledGhosts(GWWorld& w) {
+    if (w.ghostKills.empty()) return;
+    std::sort(w.ghostKills.begin(), w.ghostKills.end(), std::greater<uint32_t>());
+    for (uint32_t gi : w.ghostKills) w.ghosts.swapRemove(gi);
+    w.events.ghostsShot += (int)w.ghostKills.size();
+}
+
+// Broadphase: ผีทุกตัวลง spatial hash ตาม tile (build ใหม่ทุก tick ที่มีกระสุน, O(G)) -> ทั้งเฟสเป็น O(B + G)
+static inline void gw_stepCollisions(GWWorld& w, float dt) {
+    bool hashed = w.bullets.live > 0;
+    w.ghostKills.clear();
+    if (hashed) {
+        w.ghostHash.build(w.ghosts.size(), [&w](size_t i) { return gw_tileOf(w.ghosts.pos(i)); });
+        w.ghostDead.assign(w.ghosts.size(), 0);
+        gw_collideBullets(w, dt);
+    }
+    bool caught = gw_playerCaught(w, hashed);
+    gw_removeKilledGhosts(w);
+
+    // Player vs Ghost — รีเกมทั้งกระดาน + ปืนเกิดใหม่
+    if (caught) {
+        w.events.caught = true;
+        w.reset();
+    }
+}
+
+inline void GWWorld::step(float dt, const GWInputState& in) {
+    events = GWEvents{};
+    player.prevPos = player.pos;
+    ghosts.prevX = ghosts.x; ghosts.prevY = ghosts.y;      // ขนาดเท่าเดิม: copy ไม่ allocate
+    bullets.prevX = bullets.x; bullets.prevY = bullets.y;
+
+    {
+        GWProfileScope ps(prof, GW_PROF_PLAYER);
+        gw_stepPlayer(*this, dt, in);
+        gw_stepShoot(*this, in);
+    }
+    { GWProfileScope ps(prof, GW_PROF_GHOSTS); gw_stepGhosts(*this, dt); }
+    { GWProfileScope ps(prof, GW_PROF_BULLETS); gw_stepBullets(*this, dt); }
+    { GWProfileScope ps(prof, GW_PROF_COLLISIONS); gw_stepCollisions(*this, dt); }
+
+    if (fireCooldown > 0.0f) fireCooldown -= dt;
+    ++tick;
+}
+
+// FNV-1a ของสถานะทั้งหมดที่ sim ใช้: ไว้เทียบว่าสอง run (เช่น thread เดียว vs หลาย thread) ได้ผลเดียวกันทุก bit
+static inline uint64_t gw_worldHash(const GWWorld& w) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* p, size_t n) {
+        const unsigned char* c = (const unsigned char*)p;
+        for (size_t i = 0; i < n; ++i) { h ^= c[i]; h *= 1099511628211ull; }
+    };
+    auto mixVec = [&mix](const auto& v) { if (!v.empty()) mix(v.data(), v.size() * sizeof(v[0])); };
+    mix(&w.tick, sizeof(w.tick));
+    mix(&w.player.pos, sizeof(w.player.pos));
+    mix(&w.player.ctrl.dir, sizeof(w.player.ctrl.dir));
+    mix(&w.player.ctrl.target, sizeof(w.player.ctrl.target));
+    mix(&w.hasGun, sizeof(w.hasGun));
+    mix(&w.fireCooldown, sizeof(w.fireCooldown));
+    mixVec(w.keyTaken);
+    const GWGhosts& g = w.ghosts;
+    mixVec(g.x); mixVec(g.y); mixVec(g.tx); mixVec(g.ty); mixVec(g.dirX); mixVec(g.dirY); mixVec(g.moving); mixVec(g.yaw);
+    const GWBullets& b = w.bullets;
+    mixVec(b.x); mixVec(b.y); mixVec(b.life); mixVec(b.alive); mixVec(b.freeSlots);
+    return h;
+}
+
+// ---------------- Fixed-timestep clock ----------------
+// สะสมเวลาจริงของเฟรมแล้วรัน step ทีละ fixedDt; alpha = เศษที่เหลือ สำหรับ interpolate ตอนวาด
+struct GWSimClock {
+    float fixedDt = GW_SIM_DT;
+    float accumulator = 0.0f;
+    float maxFrame = 0.25f;     // กัน spiral of death หลังเฟรมกระตุก
+    float alpha = 0.0f;
+    bool  pendingFire = false;  // กดยิงในเฟรมที่ยังไม่ครบ tick -> เก็บไว้ให้ tick ถัดไป
+};
+
+// Run as many fixed ticks as the frame time allows; events of all ticks are merged
+// onTick(in) หลังทุก step ด้วย input ที่ tick นั้นใช้จริง (เช่น GWReplayWriter ของ gw_replay.h)
+template<class OnTick>
+static inline GWEvents gw_advance(GWWorld& w, GWSimClock& clk, float frameDt, GWInputState in, OnTick onTick) {
+    GWEvents ev;
+    if (in.fire) clk.pendingFire = true;
+    clk.accumulator += std::min(frameDt, clk.maxFrame);
+    while (clk.accumulator >= clk.fixedDt) {
+        in.fire = clk.pendingFire;
+        clk.pendingFire = false;    // edge ใช้ได้ครั้งเดียว
+        w.step(clk.fixedDt, in);
+        onTick(in);
+        ev.merge(w.events);
+        clk.accumulator -= clk.fixedDt;
+    }
+    clk.alpha = clk.accumulator / clk.fixedDt;
+    return ev;
+}
+static inline GWEvents gw_advance(GWWorld& w, GWSimClock& clk, float frameDt, const GWInputState& in) {
+    return gw_advance(w, clk, frameDt, in, [](const GWInputState&) {});
+}
+
+static inline glm::vec2 gw_lerpPos(const glm::vec2& prev, const glm::vec2& cur, float alpha) {
+    return prev + (cur - prev) * alpha;
+}
@@ -0,0 +1,186 @@
+// Grid Walk 3D — simulation benchmark suite
+// scenario ปรับได้: ขนาด maze (15..2048), จำนวนผี, กระสุน, อัตรายิง -> ticks/s, percentile ต่อเฟส, allocation ต่อ tick
+// ผลเป็น JSON (--json) ไว้เทียบระหว่าง build; ฝั่ง render ใช้ ./Assignment3 --bench (ดู README)
+// Build: g++ -std=c++17 -O3 -pthread -I<glm> -I.. gw_bench.cpp   (ไม่ต้อง link GL/GLFW)
+
+#include "../gw_world.h"
+#include "../gw_bench.h"
+#include "../gw_alloc.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static const int GW_BENCH_WARMUP = 120;     // tick ก่อนเริ่มเก็บ (scratch/capacity จองให้ครบก่อน)
+static const int GW_BENCH_RESETS = 200;     // รอบวัดเวลา reset (โดนจับ) หลังจบ tick ของ scenario
+
+struct GWBenchResult {
+    GWBenchScenario sc;
+    double setupMs = 0.0;
+    size_t ghostsEnd = 0;
+    double ticksPerSec = 0.0;
+    double allocsPerTick = 0.0;
+    long long ticksWithAllocs = 0;
+    long long shot = 0, caught = 0;
+    GWPercentiles tickUs;
+    GWPercentiles resetUs;
+    GWPercentiles phaseUs[GW_PROF_CPU_COUNT];
+};
+
+// เฟสที่ GWWorld::step จับเวลา (input/camera/render เป็นของเกม)
+static const GWProfPhase GW_SIM_PHASES[] = { GW_PROF_PLAYER, GW_PROF_GHOSTS, GW_PROF_BULLETS, GW_PROF_COLLISIONS };
+
+static GWBenchResult gw_runScenario(const GWBenchScenario& sc, GWJobSystem* jobs) {
+    GWBenchResult r;
+    r.sc = sc;
+    auto t0 = std::chrono::steady_clock::now();
+    GWWorld w;
+    w.load(gw_makeMaze(sc.size, sc.size, sc.seed));
+    w.reserve((size_t)sc.ghosts, (size_t)sc.bullets + GW_PLAYER_BULLETS);   // ยอดที่ gw_benchTopUp เติม + กระสุนของผู้เล่น
+    const std::vector<glm::ivec2> open = gw_openTiles(w.grid);
+    r.setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    w.jobs = jobs;
+    GWProfiler prof;
+    w.prof = &prof;
+    GWBot bot; bot.rng = sc.seed; bot.fireEvery = sc.fireEvery;
+    uint32_t rng = sc.seed * 2654435761u;
+
+    std::vector<double> tick, phase[GW_PROF_CPU_COUNT];
+    tick.reserve((size_t)sc.ticks);
+    for (GWProfPhase p : GW_SIM_PHASES) phase[p].reserve((size_t)sc.ticks);
+
+    unsigned long long allocs = 0;
+    double totalMs = 0.0;
+    for (long long t = -GW_BENCH_WARMUP; t < sc.ticks; ++t) {
+        gw_benchTopUp(w, sc, open, rng);
+        w.hasGun = sc.fireEvery > 0;
+        GWInputState in = bot.sample(w);
+
+        unsigned long long a0 = gw_allocCount();
+        prof.beginFrame();
+        w.step(GW_SIM_DT, in);
+        prof.endFrame();
+        unsigned long long da = gw_allocCount() - a0;
+        if (t < 0) continue;
+
+        const GWFrameStats& s = prof.current();
+        totalMs += s.frameMs;
+        tick.push_back(s.frameMs * 1000.0);
+        for (GWProfPhase p : GW_SIM_PHASES) phase[p].push_back(s.cpuMs[p] * 1000.0);
+        allocs += da;
+        r.ticksWithAllocs += da > 0;
+        r.shot += w.events.ghostsShot;
+        r.caught += w.events.caught;
+    }
+    r.ghostsEnd = w.ghosts.size();
+
+    // reset: เติมผี/กระสุนก่อนทุกรอบให้มีของให้ล้าง; ไม่ควรโตตามขนาดแผนที่
+    std::vector<double> resets;
+    resets.reserve(GW_BENCH_RESETS);
+    for (int i = 0; i < GW_BENCH_RESETS; ++i) {
+        gw_benchTopUp(w, sc, open, rng);
+        auto tr = std::chrono::steady_clock::now();
+        w.reset();
+        resets.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tr).count());
+    }
+    r.resetUs = gw_percentiles(resets);
+    r.ticksPerSec = totalMs > 0.0 ? sc.ticks * 1000.0 / totalMs : 0.0;
+    r.allocsPerTick = sc.ticks > 0 ? (double)allocs / (double)sc.ticks : 0.0;
+    r.tickUs = gw_percentiles(tick);
+    for (GWProfPhase p : GW_SIM_PHASES) r.phaseUs[p] = gw_percentiles(phase[p]);
+    return r;
+}
+
+// ชุดมาตรฐาน: จากแผนที่เล็กสุดถึง 2048x2048, ผี/กระสุนเพิ่มตามขนาด
+static std::vector<GWBenchScenario> gw_defaultSuite(double tickScale) {
+    std::vector<GWBenchScenario> s = {
+        //  name               size  ghosts bullets fire  ticks
+        { "maze15",              15,      0,      0,  15, 50000 },
+        { "maze64-g64",          64,     64,     32,  10, 20000 },
+        { "maze256-g1k",        256,   1000,    256,   5, 10000 },
+        { "maze1024-g8k",      1024,   8000,   2000,   2,  2000 },
+        { "maze2048-g32k",     2048,  32000,   8000,   1,   500 },
+    };
+    for (GWBenchScenario& sc : s) sc.ticks = std::max(1LL, (long long)(sc.ticks * tickScale));
+    return s;
+}
+
+static void gw_printResult(const GWBenchResult& r) {
+    std::printf("%-16s %5dx%-5d %6zu ghosts %5d bullets | %10.0f ticks/s  tick p50 %8.2f p99 %8.2f us |",
+        r.sc.name.c_str(), r.sc.size, r.sc.size, r.ghostsEnd, r.sc.bullets, r.ticksPerSec, r.tickUs.p50, r.tickUs.p99);
+    for (GWProfPhase p : GW_SIM_PHASES) std::printf(" %s %.2f", GW_PROF_CPU_NAMES[p], r.phaseUs[p].p50);
+    std::printf(" | reset %.2f us | %.4f allocs/tick\n", r.resetUs.p50, r.allocsPerTick);
+}
+
+static void gw_writeResult(GWJson& j, const GWBenchResult& r) {
+    j.beginObject()
+        .value("name", r.sc.name).value("map_size", r.sc.size).value("ghosts", r.sc.ghosts)
+        .value("bullets", r.sc.bullets).value("fire_every", r.sc.fireEvery)
+        .value("ticks", r.sc.ticks).value("seed", (long long)r.sc.seed)
+        .value("setup_ms", r.setupMs).value("ticks_per_sec", r.ticksPerSec)
+        .value("allocs_per_tick", r.allocsPerTick).value("ticks_with_allocs", r.ticksWithAllocs)
+        .value("ghosts_shot", r.shot).value("caught", r.caught)
+        .value("tick_us", r.tickUs).value("reset_us", r.resetUs);
+    j.beginObject("phase_us");
+    for (GWProfPhase p : GW_SIM_PHASES) j.value(GW_PROF_CPU_NAMES[p], r.phaseUs[p]);
+    j.endObject().endObject();
+}
+
+int main(int argc, char** argv) {
+    GWBenchScenario custom;
+    custom.name = "custom";
+    bool isCustom = false;
+    double tickScale = 1.0;
+    int threads = 1;
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        auto arg = [&](const char* name) { return std::strcmp(argv[i], name) == 0 && i + 1 < argc; };
+        if (arg("--size")) custom.size = std::atoi(argv[++i]), isCustom = true;
+        else if (arg("--ghosts")) custom.ghosts = std::atoi(argv[++i]), isCustom = true;
+        else if (arg("--bullets")) custom.bullets = std::atoi(argv[++i]), isCustom = true;
+        else if (arg("--fire-every")) custom.fireEvery = std::atoi(argv[++i]), isCustom = true;
+        else if (arg("--ticks")) custom.ticks = std::atoll(argv[++i]), isCustom = true;
+        else if (arg("--seed")) custom.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg("--scale")) tickScale = std::atof(argv[++i]);
+        else if (arg("--threads")) threads = std::atoi(argv[++i]);
+        else if (arg("--json")) jsonPath = argv[++i];
+        else {
+            std::cerr << "usage: gw_bench [--scale F] [--threads N (0 = all cores)] [--json FILE]\n"
+                         "                [--size N --ghosts N --bullets N --fire-every N --ticks N] [--seed S]\n"
+                         "  no scenario options = standard suite (15x15 .. 2048x2048); --scale multiplies its tick counts\n";
+            return 2;
+        }
+    }
+
+    std::vector<GWBenchScenario> suite;
+    if (isCustom) suite.push_back(custom);
+    else {
+        suite = gw_defaultSuite(tickScale);
+        for (GWBenchScenario& sc : suite) sc.seed = custom.seed;
+    }
+
+    GWJobSystem jobs(threads);
+    GWJson j;
+    j.beginObject().value("tool", "gw_bench").value("format", 1)
+#if defined(__VERSION__)
+        .value("compiler", __VERSION__)
+#endif
+        .value("threads", jobs.threadCount()).value("sim_hz", 1.0 / GW_SIM_DT).value("warmup_ticks", GW_BENCH_WARMUP);
+    j.beginArray("scenarios");
+    for (const GWBenchScenario& sc : suite) {
+        GWBenchResult r = gw_runScenario(sc, jobs.threadCount() > 1 ? &jobs : nullptr);
+        gw_printResult(r);
+        gw_writeResult(j, r);
+    }
+    j.endArray().endObject();
+
+    if (jsonPath) {
+        if (!j.save(jsonPath)) { std::cerr << "cannot write " << jsonPath << "\n"; return 1; }
+        std::printf("wrote %s\n", jsonPath);
+    }
+    return 0;
+}
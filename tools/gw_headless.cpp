@@ -0,0 +1,452 @@
+// Grid Walk 3D — headless simulation runner
+// รัน GWWorld โดยไม่มีหน้าต่าง/GPU เพื่อวัด throughput (ticks per second) บนเครื่อง CI
+// Build: g++ -std=c++17 -O3 -pthread -I<glm> -I.. gw_headless.cpp   (ไม่ต้อง link GL/GLFW)
+
+#include "../gw_world.h"
+#include "../gw_level.h"
+#include "../gw_bench.h"
+#include "../gw_replay.h"
+#include "../gw_env.h"
+#include "../gw_alloc.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// ผีเพิ่มบน tile ว่างที่อยู่ห่างจากผู้เล่น (สำหรับ stress)
+static void gw_spawnExtraGhosts(GWWorld& w, int count, uint32_t seed) {
+    if (count <= 0) return;
+    std::vector<glm::ivec2> open;
+    for (int y = 0; y < w.grid.h; ++y) for (int x = 0; x < w.grid.w; ++x) {
+        glm::ivec2 t{ x, y };
+        glm::ivec2 d = glm::abs(t - gw_tileOf(w.player.pos));
+        if (!w.wallAt(x, y) && d.x + d.y > 4) open.push_back(t);
+    }
+    if (open.empty()) return;
+    w.reserve(w.ghosts.size() + (size_t)count, 0);
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        w.ghosts.spawn(gw_centerOf(open[(seed >> 8) % open.size()]));
+    }
+}
+
+// Collision stress: B = G สุ่มบนพื้นที่ side x side (ความหนาแน่นคงที่), จับเวลาเฉพาะเฟสชน
+// และเทียบผลกับ brute force O(B*G) ที่ใช้กฎเดียวกัน (กระสุนตามลำดับ, ผี index ต่ำสุดในระยะ)
+// jobs != nullptr -> จับเวลาแบบหลาย thread และเทียบ state กับแบบ thread เดียวด้วย
+static int gw_collisionBench(uint32_t seed, GWJobSystem* jobs) {
+    bool ok = true;
+    std::printf("%8s %8s %12s %12s %14s %10s\n", "ghosts", "bullets", "hash us", "ns/(B+G)", "brute us", "kills");
+    for (int n = 1000; n <= 128000; n *= 2) {
+        float side = std::sqrt((float)n) * 2.0f;   // ~1 ตัวต่อ 4 tile
+        auto rnd = [&seed, side]() { seed = seed * 1664525u + 1013904223u; return (float)(seed >> 8) / 16777216.0f * side; };
+
+        GWWorld w;
+        w.player.pos = { -100.0f, -100.0f };        // ไกลจากทุกตัว: ไม่ให้ reset
+        for (int i = 0; i < n; ++i) { float x = rnd(); w.ghosts.spawn({ x, rnd() }); }
+        for (int i = 0; i < n; ++i) { float x = rnd(); w.bullets.spawn({ x, rnd() }, { 0, 0 }, 1.0f); }
+        const GWGhosts ghosts0 = w.ghosts;
+        const GWBullets bullets0 = w.bullets;
+
+        gw_stepCollisions(w, GW_SIM_DT);            // warm-up: ให้ scratch ของ hash จอง capacity ก่อน
+        w.ghosts = ghosts0; w.bullets = bullets0; w.events = GWEvents{};
+
+        w.jobs = jobs;
+        auto t0 = std::chrono::steady_clock::now();
+        gw_stepCollisions(w, GW_SIM_DT);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+        if (jobs) {
+            GWWorld ref;
+            ref.player.pos = w.player.pos;
+            ref.ghosts = ghosts0; ref.bullets = bullets0;
+            gw_stepCollisions(ref, GW_SIM_DT);
+            if (gw_worldHash(ref) != gw_worldHash(w)) {
+                std::printf("MISMATCH at %d: %d threads differ from 1 thread\n", n, jobs->threadCount());
+                ok = false;
+            }
+        }
+
+        // brute force reference (เฉพาะขนาดเล็ก)
+        double bruteUs = 0.0;
+        if (n <= 8000) {
+            auto tb = std::chrono::steady_clock::now();
+            std::vector<uint8_t> dead(ghosts0.size(), 0);
+            int kills = 0;
+            const float R2 = GW_HIT_RADIUS_BULLET * GW_HIT_RADIUS_BULLET;
+            for (size_t bi = 0; bi < bullets0.slots(); ++bi) {
+                for (size_t gi = 0; gi < ghosts0.size(); ++gi) {
+                    glm::vec2 d = bullets0.pos(bi) - ghosts0.pos(gi);
+                    if (dead[gi] || glm::dot(d, d) >= R2) continue;
+                    dead[gi] = 1; ++kills; break;
+                }
+            }
+            bruteUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tb).count();
+            if (kills != w.events.ghostsShot || w.ghosts.size() != ghosts0.size() - (size_t)kills) {
+                std::printf("MISMATCH at %d: brute force %d kills, hash %d\n", n, kills, w.events.ghostsShot);
+                ok = false;
+            }
+        }
+        char brute[32] = "-";
+        if (bruteUs > 0.0) std::snprintf(brute, sizeof(brute), "%.1f", bruteUs);
+        std::printf("%8d %8d %12.1f %12.2f %14s %10d\n", n, n, us, us * 1000.0 / (2.0 * n), brute, w.events.ghostsShot);
+    }
+    return ok ? 0 : 1;
+}
+
+// Swept bullets ที่ tick rate ต่ำ: กระสุนต้องหยุดที่ผนังหนา 1 tile และต้องโดนผีที่วิ่งสวนมา
+// ทุกระยะเริ่มต้น (เช็คแค่จุดปลายทาง: ที่ 5 Hz ระยะสัมพัทธ์ต่อ tick 3.4 tile > เส้นผ่านศูนย์กลาง 1.4 -> หลุดได้)
+static int gw_checkSweep() {
+    static const std::vector<std::string> ROOM = {
+        "################################",
+        "#P.............................#",
+        "#...........#..................#",
+        "#..............................#",
+        "################################" };
+    bool ok = true;
+    for (float hz : { 60.0f, 10.0f, 5.0f }) {
+        const float dt = 1.0f / hz;
+        int wallFails = 0, ghostFails = 0;
+        for (int k = 0; k < 20; ++k) {
+            const float off = 0.05f * (float)k;
+
+            // ผนังที่ x = 12 แถว 2: เดินทั้ง step (ผู้เล่นยืนนิ่ง ไม่มีผี)
+            GWWorld w;
+            w.load(ROOM);
+            w.ghosts.clear();           // load วางผีสำรองไว้เมื่อแผนที่ไม่มี 'G'
+            w.bullets.spawn({ 1.5f + off, 2.5f }, { 1, 0 }, 1.5f);
+            bool through = false;
+            for (int t = 0; t < (int)(2.0f / dt) && w.bullets.live; ++t) {
+                w.step(dt, GWInputState{});
+                through = through || (w.bullets.alive[0] && w.bullets.x[0] >= 12.0f);
+            }
+            wallFails += through || w.bullets.live != 0;
+
+            // ผีวิ่งสวนตามแถว 3 (ขยับเองแทน AI ให้ทางตรง): ต้องโดนก่อนกระสุนหมดอายุ
+            GWWorld g;
+            g.load(ROOM);
+            g.ghosts.clear();
+            g.ghosts.spawn({ 28.5f, 3.5f });
+            g.bullets.spawn({ 2.5f + off, 3.5f }, { 1, 0 }, 1.5f);
+            bool hit = false;
+            for (int t = 0; t < (int)(1.5f / dt) + 1 && !hit && g.bullets.live; ++t) {
+                g.events = GWEvents{};
+                g.ghosts.prevX = g.ghosts.x; g.ghosts.prevY = g.ghosts.y;
+                g.bullets.prevX = g.bullets.x; g.bullets.prevY = g.bullets.y;
+                g.ghosts.x[0] -= GW_STEP_SPEED_ENEMY * dt;
+                gw_stepBullets(g, dt);
+                gw_stepCollisions(g, dt);
+                hit = g.events.ghostsShot > 0;
+            }
+            ghostFails += !hit;
+        }
+        std::printf("%5.0f Hz: %.2f tiles/tick, wall tunnelling %d/20, missed ghosts %d/20\n",
+            hz, GW_BULLET_SPEED * dt, wallFails, ghostFails);
+        ok = ok && wallFails == 0 && ghostFails == 0;
+    }
+    return ok ? 0 : 1;
+}
+
+// Reachability: maze 1025x1025, ผู้เล่นยืนนิ่งที่ P, ผีตัวเดียวเกิดห่าง 200-400 tile (Manhattan) ต้องถึงผู้เล่นภายใน 200k tick
+// รันสองโหมด: flow field ทั้งแผนที่ (ขนาดนี้ใช้จริง) และหน้าต่าง + chunk flow (บังคับด้วย flowFullTiles = 0)
+// เดิมหน้าต่างอย่างเดียว + greedy นอกหน้าต่าง: ผีติดทางตันแทบทุกตัว
+static int gw_checkReach() {
+    const GWGrid maze = GWGrid::fromText(gw_makeMaze(1025, 1025, 7));
+    const std::vector<glm::ivec2> open = gw_openTiles(maze);
+    const int TRIALS = 20;
+    const long long LIMIT = 200000;
+    bool ok = true;
+    for (size_t fullTiles : { GW_FLOW_FULL_TILES, (size_t)0 }) {
+        GWWorld w;
+        w.flowFullTiles = fullTiles;
+        w.load(maze);
+        const glm::ivec2 pt = gw_tileOf(w.playerSpawn);
+        uint32_t rng = 7;
+        int reached = 0;
+        long long sum = 0, worst = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < TRIALS; ++k) {
+            glm::ivec2 gt;
+            do {
+                rng = rng * 1664525u + 1013904223u;
+                gt = open[(rng >> 8) % open.size()];
+            } while (std::abs(gt.x - pt.x) + std::abs(gt.y - pt.y) < 200 || std::abs(gt.x - pt.x) + std::abs(gt.y - pt.y) > 400);
+            w.reset();
+            w.ghosts.clear();
+            w.ghosts.spawn(gw_centerOf(gt));
+            long long t = 0;
+            for (; t < LIMIT; ++t) {
+                w.step(GW_SIM_DT, GWInputState{});
+                if (w.events.caught) break;
+            }
+            if (t < LIMIT) { ++reached; sum += t + 1; worst = std::max(worst, t + 1); }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("%-22s reached %d/%d (mean %.0f ticks, worst %lld) in %.2f s\n",
+            fullTiles ? "full-map flow field:" : "window + chunk flow:", reached, TRIALS,
+            reached ? (double)sum / reached : 0.0, worst, sec);
+        ok = ok && reached == TRIALS;
+    }
+    return ok ? 0 : 1;
+}
+
+// Steady state ไม่ allocate: หลัง load (+ reserve ตามยอดที่จะเติม) ทุก step ต้องได้ 0 allocation ตั้งแต่ tick แรก
+// ทั้งแผนที่เกม (bot ถือปืน, โดนจับ -> reset) และ scenario ของ benchmark ที่เติมผี/กระสุนทุก tick; thread เดียวและ job system
+// นับเฉพาะ step (bot / การเติมอยู่นอกช่วงที่นับ)
+static int gw_checkAllocs(long long ticks, GWJobSystem& jobs) {
+    GWBenchScenario game;
+    game.name = "default-map"; game.size = 0; game.ghosts = 0; game.bullets = 0; game.fireEvery = 4;
+    GWBenchScenario small, mid, large;
+    small.name = "maze64-g64"; small.size = 64; small.ghosts = 64; small.bullets = 32; small.fireEvery = 10;
+    mid.name = "maze256-g1k"; mid.size = 256; mid.ghosts = 1000; mid.bullets = 256; mid.fireEvery = 5;
+    // หลายก้อนต่อ parallelFor (เกิน GW_JOB_GRAIN_*) -> job system ทำงานจริง
+    large.name = "maze512-g8k"; large.size = 512; large.ghosts = 8000; large.bullets = 8200; large.fireEvery = 2;
+
+    bool ok = true;
+    for (const GWBenchScenario& sc : { game, small, mid, large }) {
+        for (GWJobSystem* js : { (GWJobSystem*)nullptr, &jobs }) {
+            GWWorld w;
+            if (sc.size > 0) w.load(gw_makeMaze(sc.size, sc.size, sc.seed));
+            else w.load(GW_DEFAULT_MAP);
+            w.reserve((size_t)sc.ghosts, (size_t)sc.bullets + GW_PLAYER_BULLETS);
+            w.jobs = js;
+            const std::vector<glm::ivec2> open = gw_openTiles(w.grid);
+            GWBot bot; bot.rng = sc.seed; bot.fireEvery = sc.fireEvery;
+            uint32_t rng = sc.seed * 2654435761u;
+
+            unsigned long long allocs = 0;
+            long long allocTicks = 0, first = -1, caught = 0;
+            for (long long t = 0; t < ticks; ++t) {
+                if (sc.size > 0) gw_benchTopUp(w, sc, open, rng);
+                w.hasGun = true;
+                GWInputState in = bot.sample(w);
+                const unsigned long long a0 = gw_allocCount();
+                w.step(GW_SIM_DT, in);
+                const unsigned long long da = gw_allocCount() - a0;
+                allocs += da;
+                allocTicks += da > 0;
+                if (da > 0 && first < 0) first = t;
+                caught += w.events.caught;
+            }
+            std::printf("%-12s %2d threads: %lld ticks, %llu allocations in %lld ticks (first at %lld), caught %lld\n",
+                sc.name.c_str(), js ? js->threadCount() : 1, ticks, allocs, allocTicks, first, caught);
+            ok = ok && allocs == 0;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+// Batched environment: N เกมบนแผนที่เดียวกัน, bot ของแต่ละเกม seed ต่างกัน -> ticks/s รวม + allocation ระหว่าง step
+// แล้วเล่นเกมตัวอย่างซ้ำด้วย GWWorld เดี่ยวๆ (action เดียวกัน) ต้องได้ hash เดียวกันทุก tick: batch ไม่เปลี่ยนผลของเกม
+static int gw_runEnvs(const GWGrid& grid, size_t n, long long ticks, uint32_t seed, GWJobSystem& jobs) {
+    GWEnvConfig cfg;
+    GWEnvBatch env(grid, n, cfg, jobs.threadCount() > 1 ? &jobs : nullptr);
+    std::vector<GWBot> bots(n);
+    for (size_t i = 0; i < n; ++i) { bots[i].rng = seed + (uint32_t)i * 7919u; bots[i].fireEvery = 12; }
+    std::vector<uint8_t> actions(n);
+
+    const size_t samples = std::min<size_t>(n, 8);
+    auto sampleIndex = [n, samples](size_t k) { return k * n / samples; };
+    std::vector<uint64_t> hashes;
+    hashes.reserve(samples * (size_t)ticks);
+
+    long long shot = 0, caught = 0, picked = 0;
+    unsigned long long allocs = 0;
+    double sec = 0.0;
+    for (long long t = 0; t < ticks; ++t) {
+        for (size_t i = 0; i < n; ++i) actions[i] = gw_envAction(bots[i].sample(env.world(i)));
+        const unsigned long long a0 = gw_allocCount();
+        auto t0 = std::chrono::steady_clock::now();
+        env.step(actions.data());
+        sec += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        allocs += gw_allocCount() - a0;
+        for (size_t i = 0; i < n; ++i) {
+            const GWEnvEvent& ev = env.events()[i];
+            shot += ev.ghostsShot; caught += ev.caught; picked += ev.gunPicked;
+        }
+        for (size_t k = 0; k < samples; ++k) hashes.push_back(gw_worldHash(env.world(sampleIndex(k))));
+    }
+    std::printf("%zu envs x %lld ticks, %d threads: %.3f s in step -> %.0f ticks/s aggregate (%.3f us/tick per core)\n",
+        n, ticks, jobs.threadCount(), sec, (double)env.totalTicks() / std::max(sec, 1e-9),
+        sec * 1e6 * jobs.threadCount() / std::max<double>((double)env.totalTicks(), 1.0));
+    std::printf("observation: %dx%d tiles + %zu floats per env; guns picked %lld, ghosts shot %lld, caught %lld; %llu allocations in step\n",
+        env.viewSize(), env.viewSize(), env.statePerEnv(), picked, shot, caught, allocs);
+
+    for (size_t k = 0; k < samples; ++k) {
+        const size_t i = sampleIndex(k);
+        GWWorld w;
+        w.load(grid);
+        GWBot bot; bot.rng = seed + (uint32_t)i * 7919u; bot.fireEvery = 12;
+        for (long long t = 0; t < ticks; ++t) {
+            w.step(GW_SIM_DT, gw_envInput(gw_envAction(bot.sample(w))));
+            if (gw_worldHash(w) == hashes[(size_t)t * samples + k]) continue;
+            std::printf("env %zu DIVERGED from a standalone world at tick %lld\n", i, t + 1);
+            return 1;
+        }
+    }
+    std::printf("%zu sampled envs identical to standalone worlds\n", samples);
+    return allocs == 0 ? 0 : 1;
+}
+
+static bool gw_loadTextMap(const char* path, std::vector<std::string>& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) out.push_back(line);
+    }
+    return !out.empty();
+}
+
+struct GWRunStats {
+    long long shot = 0, caught = 0;
+    double sec = 0.0;
+};
+
+// รัน ticks ครั้งด้วย bot; armed = ให้ผู้เล่นถือปืนตลอด (ให้เฟสกระสุน/ชนมีงานทำ)
+// hashes != nullptr -> เก็บ gw_worldHash ทุก tick; rec != nullptr -> อัด input ลง .gwr
+static GWRunStats gw_runSim(GWWorld& world, long long ticks, float dt, int extraGhosts, uint32_t seed,
+    bool armed, std::vector<uint64_t>* hashes, GWReplayWriter* rec = nullptr) {
+    GWBot bot; bot.rng = seed;
+    GWChunkResidency res;       // .gwl: เก็บเฉพาะ chunk รอบผู้เล่น (แผนที่ข้อความไม่มีผล)
+    GWRunStats st;
+    auto t0 = std::chrono::steady_clock::now();
+    for (long long t = 0; t < ticks; ++t) {
+        if (armed) world.hasGun = true;
+        GWInputState in = bot.sample(world);
+        world.step(dt, in);
+        if (rec) rec->tick(in, world);
+        res.update(world.grid, gw_tileOf(world.player.pos), GW_LEVEL_RESIDENT_RADIUS);
+        st.shot += world.events.ghostsShot;
+        if (world.events.caught) { ++st.caught; gw_spawnExtraGhosts(world, extraGhosts, seed + (uint32_t)st.caught); }
+        if (hashes) hashes->push_back(gw_worldHash(world));
+    }
+    st.sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return st;
+}
+
+int main(int argc, char** argv) {
+    long long ticks = 100000;
+    int extraGhosts = 0;
+    uint32_t seed = 1;
+    float dt = GW_SIM_DT;
+    const char* mapPath = nullptr;
+    bool collisionBench = false;
+    bool checkThreads = false;
+    bool checkSweep = false;
+    bool checkAllocs = false;
+    bool checkReach = false;
+    long long envs = 0;
+    int threads = 1;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        auto arg = [&](const char* name) { return std::strcmp(argv[i], name) == 0 && i + 1 < argc; };
+        if (arg("--ticks")) ticks = std::atoll(argv[++i]);
+        else if (arg("--ghosts")) extraGhosts = std::atoi(argv[++i]);
+        else if (arg("--seed")) seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg("--hz")) dt = 1.0f / (float)std::atof(argv[++i]);
+        else if (arg("--map")) mapPath = argv[++i];
+        else if (arg("--threads")) threads = std::atoi(argv[++i]);
+        else if (arg("--record")) recordPath = argv[++i];
+        else if (arg("--replay")) replayPath = argv[++i];
+        else if (arg("--envs")) envs = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--collision-bench") == 0) collisionBench = true;
+        else if (std::strcmp(argv[i], "--check-threads") == 0) checkThreads = true;
+        else if (std::strcmp(argv[i], "--check-sweep") == 0) checkSweep = true;
+        else if (std::strcmp(argv[i], "--check-allocs") == 0) checkAllocs = true;
+        else if (std::strcmp(argv[i], "--check-reach") == 0) checkReach = true;
+        else {
+            std::cerr << "usage: gw_headless [--ticks N] [--ghosts N] [--seed S] [--hz RATE] [--map FILE] [--threads N (0 = all cores)]\n"
+                         "                   [--collision-bench] [--check-threads] [--check-sweep] [--check-allocs] [--check-reach]\n"
+                         "                   [--record FILE.gwr] [--replay FILE.gwr]\n"
+                         "                   [--envs N]   (N games in one batch, see gw_env.h)\n";
+            return 2;
+        }
+    }
+
+    GWJobSystem jobs((checkThreads || checkAllocs) && threads == 1 ? 4 : threads);
+    if (collisionBench) return gw_collisionBench(seed, jobs.threadCount() > 1 ? &jobs : nullptr);
+    if (checkSweep) return gw_checkSweep();
+    if (checkReach) return gw_checkReach();
+    if (checkAllocs) return gw_checkAllocs(std::min(ticks, 5000LL), jobs);
+
+    // --replay: แผนที่ตามที่อัดไว้ (--map ใช้แทนได้ เช่นไฟล์ย้ายที่)
+    GWReplay replay;
+    std::string err;
+    if (replayPath) {
+        if (!replay.load(replayPath, &err)) { std::cerr << err << "\n"; return 1; }
+        if (!mapPath && !replay.mapPath.empty()) mapPath = replay.mapPath.c_str();
+    }
+    if (recordPath && extraGhosts > 0) { std::cerr << "--record cannot be combined with --ghosts (spawns happen outside step)\n"; return 2; }
+
+    // --map: แผนที่ข้อความ หรือ .gwl (ดูจาก magic) ซึ่ง map เข้ามาโดยไม่ copy
+    GWGrid grid;
+    std::vector<std::string> text;
+    if (!mapPath) grid = GWGrid::fromText(GW_DEFAULT_MAP);
+    else if (gw_isLevelFile(mapPath)) {
+        if (!gw_openLevelFile(mapPath, grid, &err)) { std::cerr << err << "\n"; return 1; }
+    }
+    else if (gw_loadTextMap(mapPath, text)) grid = GWGrid::fromText(text);
+    else { std::cerr << "cannot read map " << mapPath << "\n"; return 1; }
+
+    if (envs > 0) return gw_runEnvs(grid, (size_t)envs, ticks, seed, jobs);
+
+    // รันแบบ thread เดียวกับแบบ job system (ผู้เล่นถือปืน) แล้วเทียบ hash ของ world ทุก tick
+    if (checkThreads) {
+        std::vector<uint64_t> ref, mt;
+        GWWorld a, b;
+        a.load(grid); gw_spawnExtraGhosts(a, extraGhosts, seed);
+        b.load(grid); gw_spawnExtraGhosts(b, extraGhosts, seed);
+        b.jobs = &jobs;
+        GWRunStats sa = gw_runSim(a, ticks, dt, extraGhosts, seed, true, &ref);
+        GWRunStats sb = gw_runSim(b, ticks, dt, extraGhosts, seed, true, &mt);
+        for (size_t t = 0; t < ref.size(); ++t) {
+            if (ref[t] == mt[t]) continue;
+            std::printf("DIVERGED at tick %zu (1 thread vs %d threads)\n", t + 1, jobs.threadCount());
+            return 1;
+        }
+        std::printf("identical over %lld ticks: 1 thread %.3f s, %d threads %.3f s (shot %lld, caught %lld)\n",
+            ticks, sa.sec, jobs.threadCount(), sb.sec, sb.shot, sb.caught);
+        return 0;
+    }
+
+    GWWorld world;
+    world.load(std::move(grid));
+    gw_spawnExtraGhosts(world, extraGhosts, seed);
+    if (jobs.threadCount() > 1) world.jobs = &jobs;
+
+    // เล่นซ้ำเต็มความเร็ว + เทียบ hash ทุก tick; exit 1 ถ้าต่างจากตอนอัด
+    if (replayPath) {
+        if (world.grid.hash() != replay.header.mapHash) {
+            std::cerr << "map " << (mapPath ? mapPath : "(built-in)") << " does not match the recording\n";
+            return 1;
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        GWReplayResult r = gw_runReplay(world, replay);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("replay %s: %llu/%zu ticks in %.3f s -> %.0f ticks/s (%d threads)\n", replayPath,
+            (unsigned long long)r.ticks, replay.ticks(), sec, r.ticks / std::max(sec, 1e-9), jobs.threadCount());
+        if (r.divergedAt >= 0) {
+            std::printf("DIVERGED at tick %lld: hash %08x, recorded %08x\n", (long long)r.divergedAt + 1, r.actual, r.expected);
+            return 1;
+        }
+        std::printf("identical to the recording on every tick\n");
+        return 0;
+    }
+
+    GWReplayWriter rec;
+    if (recordPath && !rec.open(recordPath, world, mapPath ? mapPath : "", 0, dt, &err)) { std::cerr << err << "\n"; return 1; }
+    GWRunStats st = gw_runSim(world, ticks, dt, extraGhosts, seed, false, nullptr, recordPath ? &rec : nullptr);
+
+    std::printf("map %dx%d (%zu B grid), ghosts %zu, threads %d, ticks %lld in %.3f s -> %.0f ticks/s (%.2f us/tick)\n",
+        world.grid.w, world.grid.h, world.grid.bytes(), world.ghosts.size(), jobs.threadCount(),
+        ticks, st.sec, ticks / st.sec, st.sec * 1e6 / (double)ticks);
+    std::printf("ghosts shot %lld, caught %lld\n", st.shot, st.caught);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Grid Walk 3D — text map -> binary level (.gwl) converter
+// อ่านแผนที่แบบข้อความ (รูปแบบเดียวกับ GW_DEFAULT_MAP) แล้วเขียนเป็น .gwl สำหรับ mmap
+// --bench: เทียบเวลาเริ่มเกมและหน่วยความจำที่ใช้จริง (RSS) ระหว่างทาง text กับทาง .gwl
+// Build: g++ -std=c++17 -O3 -pthread -I<glm> -I.. gw_levelconv.cpp   (ไม่ต้อง link GL/GLFW)
+
+#include "../gw_world.h"
+#include "../gw_level.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static bool gw_loadTextMap(const char* path, std::vector<std::string>& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) out.push_back(line);
+    }
+    return !out.empty();
+}
+
+// resident set ของ process (KiB); -1 ถ้าอ่านไม่ได้ (ไม่ใช่ Linux)
+static long gw_residentKiB() {
+    std::ifstream f("/proc/self/statm");
+    long size = 0, resident = -1;
+    if (!(f >> size >> resident)) return -1;
+    return resident * (long)(sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// เริ่มเกม (load + tick แรก ซึ่ง build flow field) แล้วเดินต่ออีก ticks ครั้ง; คืนเวลาเริ่ม (ms)
+template<class LoadFn>
+static double gw_benchPath(const char* name, LoadFn load, int ticks) {
+    long rss0 = gw_residentKiB();
+    auto t0 = std::chrono::steady_clock::now();
+    GWWorld w;
+    load(w);
+    w.step(GW_SIM_DT, GWInputState{});
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    long rssStart = gw_residentKiB();
+
+    GWChunkResidency res;
+    GWInputState in;
+    static const glm::ivec2 DIRS[4] = { {1,0},{0,1},{-1,0},{0,-1} };
+    for (int t = 0; t < ticks; ++t) {
+        in.dir = DIRS[(t / 240) & 3];
+        w.step(GW_SIM_DT, in);
+        res.update(w.grid, gw_tileOf(w.player.pos), GW_LEVEL_RESIDENT_RADIUS);
+    }
+    long rssEnd = gw_residentKiB();
+    std::printf("%-6s startup %9.2f ms   rss +%8ld KiB after start, +%8ld KiB after %d ticks\n",
+        name, ms, rssStart - rss0, rssEnd - rss0, ticks);
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    bool bench = false;
+    const char* in = nullptr;
+    const char* out = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0) bench = true;
+        else if (!in) in = argv[i];
+        else if (!out) out = argv[i];
+        else in = nullptr, i = argc;
+    }
+    if (!in || !out) {
+        std::cerr << "usage: gw_levelconv [--bench] MAP.txt OUT.gwl\n";
+        return 2;
+    }
+
+    std::vector<std::string> text;
+    if (!gw_loadTextMap(in, text)) { std::cerr << "cannot read map " << in << "\n"; return 1; }
+    GWGrid g = GWGrid::fromText(text);
+    text.clear(); text.shrink_to_fit();
+    std::string err;
+    if (!gw_writeLevelFile(g, out, &err)) { std::cerr << err << "\n"; return 1; }
+
+    // อ่านกลับมาเทียบทุก tile + ตาราง: ไฟล์ที่เขียนต้องเหมือนต้นฉบับ
+    GWGrid m;
+    if (!gw_openLevelFile(out, m, &err)) { std::cerr << err << "\n"; return 1; }
+    bool same = m.w == g.w && m.h == g.h && m.keys == g.keys &&
+        m.playerSpawns == g.playerSpawns && m.ghostSpawns == g.ghostSpawns;
+    for (int y = -GWGrid::PAD; same && y < g.h + GWGrid::PAD; ++y)
+        for (int x = -GWGrid::PAD; same && x < g.w + GWGrid::PAD; ++x)
+            same = m.wall(x, y) == g.wall(x, y);
+    // hash ใน header ต้องตรงกับเนื้อไฟล์จริง (replay เทียบแผนที่ด้วยค่านี้)
+    same = same && m.hash() == g.hash() && m.hash() == m.scanHash();
+    if (!same) { std::cerr << "round trip mismatch for " << out << "\n"; return 1; }
+    std::printf("%s: %dx%d, %zu walls, %d x %d chunks, %zu B bitmap, %zu keys, %zu ghost spawns\n",
+        out, g.w, g.h, g.countWalls(), g.cw, g.ch, g.bytes(), g.keys.size(), g.ghostSpawns.size());
+    g = GWGrid{}; m = GWGrid{};
+    if (!bench) return 0;
+
+    // .gwl ก่อน: RSS ของทาง text (string + bitset บน heap) อาจไม่คืน OS หมดหลังจบ
+    const int ticks = 2000;
+    gw_benchPath("gwl", [&](GWWorld& w) {
+        GWGrid lg;
+        if (!gw_openLevelFile(out, lg, &err)) { std::cerr << err << "\n"; std::exit(1); }
+        w.load(std::move(lg));
+    }, ticks);
+    gw_benchPath("text", [&](GWWorld& w) {
+        std::vector<std::string> t;
+        if (!gw_loadTextMap(in, t)) std::exit(1);
+        w.load(t);
+    }, ticks);
+    return 0;
+}